@@ -1,30 +1,32 @@
 #include <iostream>
-#include <fstream>
+#include <optional>
 #include <cact-front-end/CactLexer.h>
 #include <cact-front-end/CactParser.h>
 #include <cact-front-end/cact-syntax-error-listener.h>
 #include <cact-front-end/symbol-registration-visitor.h>
 // #include <cact-front-end/cact-symbol-registration-visitor.h>
-#include <antlr-runtime/ANTLRInputStream.h>
 #include <antlr-runtime/CommonTokenStream.h>
+#include <chiisai-llvm/mapped-char-stream.h>
 
 int main(int argc, char *argv[]) {
   if (argc != 2) {
     std::cerr << "Usage: " << argv[0] << " <input file>" << std::endl;
     return 1;
   }
-  std::ifstream stream(argv[1]);
-  if (!stream) {
+  // the source is mapped once, then echoed and lexed in place
+  std::optional<llvm::MappedCharStream> mapped{};
+  try {
+    mapped.emplace(argv[1]);
+  } catch (const std::exception &) {
     std::cerr << "Failed to open file: " << argv[1] << std::endl;
     return 1;
   }
+  auto &input = *mapped;
 
   // print the source file's content
-  std::ifstream streamCopy(argv[1]);
   std::cout << "Source file content:" << std::endl;
-  std::cout << streamCopy.rdbuf() << std::endl;
+  std::cout << input.text() << std::endl;
 
-  antlr4::ANTLRInputStream input(stream);
   cactfrontend::CactLexer lexer(&input);
   antlr4::CommonTokenStream tokens(&lexer);
   cactfrontend::CactParser parser(&tokens);
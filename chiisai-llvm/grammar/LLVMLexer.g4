@@ -68,11 +68,10 @@ Colon: ':';
 Cross: 'x';
 GetElementPtr: 'getelementptr';
 
-NumericIdentifier: [0-9]+;
 NamedIdentifier: [a-zA-Z_][a-zA-Z0-9_]*;
 
-// Integer literals
-IntegerLiteral: [1-9][0-9]*;
+// Integer literals, which also number unnamed values
+IntegerLiteral: [0-9]+;
 
 // Floating-point literals
 FloatLiteral: [0-9]+'.'[0-9]+;
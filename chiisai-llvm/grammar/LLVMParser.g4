@@ -37,7 +37,7 @@ globalIdentifier: At NamedIdentifier;
 
 localIdentifier: Percent NamedIdentifier;
 
-unamedIdentifier: Percent NumericIdentifier;
+unamedIdentifier: Percent IntegerLiteral;
 
 localVariable: localIdentifier | unamedIdentifier;
 
@@ -59,10 +59,7 @@ value
 
 module: (globalDeclaration | functionDefinition)*;
 
-initializer
-locals[
-    Literal result,
-]: IntegerLiteral | FloatLiteral | constantArray;
+initializer: IntegerLiteral | FloatLiteral | constantArray;
 
 constantArray
 locals[
@@ -99,7 +96,7 @@ parameter
 basicBlock
   locals [
       std::unique_ptr<BasicBlock> basicBlockInstance,
-]: Label Colon instruction*;
+]: NamedIdentifier Colon instruction*;
 
 instruction
   locals [
@@ -120,7 +117,11 @@ returnInstruction: Ret type value?;
 branchInstruction: Br I1 variable Comma Label localVariable Comma Label localVariable
                 | Br Label localVariable;
 
-callInstruction: (unamedIdentifier Equals)? Call type globalIdentifier functionArguments;
+callInstruction: (unamedIdentifier Equals)? Call type globalIdentifier callArguments;
+
+callArguments: LeftParen (callArgument (Comma callArgument)*)? RightParen;
+
+callArgument: number | type variable;
 
 arithmeticInstruction
     : unamedIdentifier Equals binaryOperation type value Comma value
@@ -135,10 +136,10 @@ storeInstruction
     ;
 
 phiInstruction
-    : Phi type phiValue (Comma phiValue)*
+    : unamedIdentifier Equals Phi type phiValue (Comma phiValue)*
     ;
 
-phiValue: LeftBrace unamedIdentifier Comma value RightBrace;
+phiValue: LeftBrace localVariable Comma value RightBrace;
 
 comparisonOperation : Icmp | Fcmp;
 
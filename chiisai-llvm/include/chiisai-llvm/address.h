@@ -4,13 +4,18 @@
 
 #ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_ADDRESS_H
 #define CACTRIE_CHIISAI_LLVM_INCLUDE_ADDRESS_H
-#include <variant>
-#include <chiisai-llvm/value.h>
+#include <cstddef>
 namespace llvm {
 
+struct Result;
+/**
+ * @brief an address in the executor's memory
+ * memory is a sequence of scalar cells, base points to the first cell of the allocation
+ * and index is the offset of the addressed cell within it
+ */
 struct Address {
-  Ref<Value> value;
-  size_t index;
+  Result *base{};
+  size_t index{};
 };
 }
 #endif //CACTRIE_CHIISAI_LLVM_INCLUDE_ADDRESS_H
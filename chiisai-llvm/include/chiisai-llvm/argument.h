@@ -8,7 +8,10 @@
 namespace llvm {
 
 struct Argument : Value {
-  explicit Argument(const std::string &name, CRef<Type> type) : Value(name, type) {}
+  explicit Argument(const std::string &name, CRef<Type> type) : Value(Kind::Argument, name, type) {}
+  static bool classof(const Value *value) {
+    return value->kind() == Kind::Argument;
+  }
 };
 
 }
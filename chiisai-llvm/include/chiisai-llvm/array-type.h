@@ -10,6 +10,9 @@ namespace llvm {
 struct ArrayType : Type {
 
   explicit ArrayType(CRef<Type> elementType, size_t size) : Type(TypeEnum::Array, {elementType}), size(size) {}
+  static bool classof(const Type *type) {
+    return type->type == TypeEnum::Array;
+  }
   size_t size{};
   [[nodiscard]] CRef<Type> elementType() const {
     return containedTypes[0];
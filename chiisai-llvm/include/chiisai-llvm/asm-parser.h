@@ -0,0 +1,31 @@
+//
+// Created by creeper on 10/18/26.
+//
+
+#ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_ASM_PARSER_H
+#define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_ASM_PARSER_H
+#include <memory>
+#include <cstddef>
+#include <string_view>
+#include <filesystem>
+namespace llvm {
+
+struct Module;
+class LLVMContext;
+
+/**
+ * @brief builds a module from textual IR without a parse tree, i.e. the fast counterpart of ModuleBuilder
+ * the text is lexed on demand and every construct is built as soon as it is read, by recursive descent
+ * it takes the syntax of LLVMParser.g4, building the same IR as ModuleBuilder, and that printed by AsmWriter,
+ * so that printing a module and parsing the text back gives a module that prints the same
+ * the globals and the signatures are read first, so bodies may use globals and call functions defined after them
+ * with a threadCount above 1, the bodies are then built on that many threads, which scales with the number of functions
+ * errors are thrown as std::runtime_error, with the line they were found on, the first in the text if several bodies fail
+ * ctx must outlive the module, which refers to nothing of the text once it is built
+ */
+std::unique_ptr<Module> parseAssembly(std::string_view text, LLVMContext &ctx, size_t threadCount = 1);
+// parses the file through a read-only mapping, see MappedFile
+std::unique_ptr<Module> readAssembly(const std::filesystem::path &path, LLVMContext &ctx, size_t threadCount = 1);
+
+}
+#endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_ASM_PARSER_H
@@ -0,0 +1,59 @@
+//
+// Created by creeper on 10/18/26.
+//
+
+#ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_ASM_WRITER_H
+#define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_ASM_WRITER_H
+#include <string>
+#include <thread>
+#include <chiisai-llvm/properties.h>
+namespace llvm {
+
+struct Type;
+struct Module;
+struct Function;
+struct GlobalVariable;
+
+/**
+ * @brief prints modules as textual IR, straight to a file descriptor through one large buffer that is reused
+ * the text only depends on the IR, so printing the same module twice gives the same bytes:
+ * values without a name are numbered in the order they are printed, starting over in every function
+ * usage:
+ *   AsmWriter(STDOUT_FILENO).print(module);
+ */
+struct AsmWriter : NonCopyable {
+  static constexpr size_t DefaultBufferSize = size_t{1} << 20;
+
+  // the descriptor is not closed by the writer
+  explicit AsmWriter(int fd, size_t bufferSize = DefaultBufferSize);
+  AsmWriter(AsmWriter &&) = delete;
+  // flushes, but cannot report a failure to do so, call flush() first to see it
+  ~AsmWriter();
+
+  // functions that are not materialized yet are materialized to be printed
+  AsmWriter &print(Module &module);
+  AsmWriter &print(Function &function);
+  AsmWriter &print(const GlobalVariable &global);
+  /**
+   * @brief prints the functions of a module on several threads, and writes them in the order of the module
+   * each function is formatted into its own text, and a text is written and freed as soon as the texts of the
+   * functions before it are written, so the output is the same as that of print(module)
+   */
+  AsmWriter &printParallel(Module &module, size_t threadCount = std::thread::hardware_concurrency());
+  // writes out everything printed so far, throwing if the descriptor does not take it
+  AsmWriter &flush();
+
+  // the text of a function, e.g. for debugging or for tests
+  [[nodiscard]] static std::string str(Function &function);
+  [[nodiscard]] static std::string str(const Type &type);
+private:
+  void append(std::string_view text);
+  void flushIfFull();
+  void writeOut(std::string_view text);
+  int m_fd;
+  size_t m_bufferSize;
+  std::string m_buffer{};
+};
+
+}
+#endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_ASM_WRITER_H
@@ -22,8 +22,8 @@ public:
     Sgt = 42, Sge = 43, Slt = 44, Sle = 45, Equals = 46, Comma = 47, LeftParen = 48, 
     RightParen = 49, LeftBrace = 50, RightBrace = 51, LeftBracket = 52, 
     RightBracket = 53, At = 54, Percent = 55, Asterisk = 56, Colon = 57, 
-    Cross = 58, GetElementPtr = 59, NumericIdentifier = 60, NamedIdentifier = 61, 
-    IntegerLiteral = 62, FloatLiteral = 63, Whitespace = 64, Comment = 65
+    Cross = 58, GetElementPtr = 59, NamedIdentifier = 60, IntegerLiteral = 61, 
+    FloatLiteral = 62, Whitespace = 63, Comment = 64
   };
 
   explicit LLVMLexer(antlr4::CharStream *input);
@@ -30,23 +30,27 @@ public:
     Sgt = 42, Sge = 43, Slt = 44, Sle = 45, Equals = 46, Comma = 47, LeftParen = 48, 
     RightParen = 49, LeftBrace = 50, RightBrace = 51, LeftBracket = 52, 
     RightBracket = 53, At = 54, Percent = 55, Asterisk = 56, Colon = 57, 
-    Cross = 58, GetElementPtr = 59, NumericIdentifier = 60, NamedIdentifier = 61, 
-    IntegerLiteral = 62, FloatLiteral = 63, Whitespace = 64, Comment = 65
+    Cross = 58, GetElementPtr = 59, NamedIdentifier = 60, IntegerLiteral = 61, 
+    FloatLiteral = 62, Whitespace = 63, Comment = 64
   };
 
   enum {
     RuleScalarType = 0, RuleBasicType = 1, RuleType = 2, RulePointerType = 3, 
     RuleArrayType = 4, RuleGlobalIdentifier = 5, RuleLocalIdentifier = 6, 
-    RuleUnamedIdentifier = 7, RuleLocalVariable = 8, RuleVariable = 9, RuleLiteral = 10, 
-    RuleNumber = 11, RuleValue = 12, RuleModule = 13, RuleInitializer = 14, 
-    RuleConstantArray = 15, RuleGlobalDeclaration = 16, RuleFunctionDefinition = 17, 
-    RuleFunctionArguments = 18, RuleParameterList = 19, RuleParameter = 20, 
-    RuleBasicBlock = 21, RuleInstruction = 22, RuleReturnInstruction = 23, 
-    RuleBranchInstruction = 24, RuleCallInstruction = 25, RuleArithmeticInstruction = 26, 
-    RuleLoadInstruction = 27, RuleStoreInstruction = 28, RulePhiInstruction = 29, 
-    RulePhiValue = 30, RuleComparisonOperation = 31, RuleComparisonInstruction = 32, 
-    RuleAllocaInstruction = 33, RuleBinaryOperation = 34, RuleComparisonPredicate = 35, 
-    RuleTerminatorInstruction = 36, RuleGepInstruction = 37
+    RuleUnamedIdentifier = 7, RuleLocalVariable = 8, RuleVariable = 9, 
+    RuleLiteral = 10, RuleNumber = 11, RuleValue = 12, RuleModule = 13, 
+    RuleInitializer = 14, RuleConstantArray = 15, RuleGlobalDeclaration = 16, 
+    RuleFunctionDefinition = 17, RuleFunctionArguments = 18, 
+    RuleParameterList = 19, RuleParameter = 20, RuleBasicBlock = 21, 
+    RuleInstruction = 22, RuleReturnInstruction = 23, 
+    RuleBranchInstruction = 24, RuleCallInstruction = 25, 
+    RuleCallArguments = 26, RuleCallArgument = 27, 
+    RuleArithmeticInstruction = 28, RuleLoadInstruction = 29, 
+    RuleStoreInstruction = 30, RulePhiInstruction = 31, RulePhiValue = 32, 
+    RuleComparisonOperation = 33, RuleComparisonInstruction = 34, 
+    RuleAllocaInstruction = 35, RuleBinaryOperation = 36, 
+    RuleComparisonPredicate = 37, RuleTerminatorInstruction = 38, 
+    RuleGepInstruction = 39
   };
 
   explicit LLVMParser(antlr4::TokenStream *input);
@@ -92,6 +96,8 @@ public:
   class ReturnInstructionContext;
   class BranchInstructionContext;
   class CallInstructionContext;
+  class CallArgumentsContext;
+  class CallArgumentContext;
   class ArithmeticInstructionContext;
   class LoadInstructionContext;
   class StoreInstructionContext;
@@ -222,7 +228,7 @@ public:
     UnamedIdentifierContext(antlr4::ParserRuleContext *parent, size_t invokingState);
     virtual size_t getRuleIndex() const override;
     antlr4::tree::TerminalNode *Percent();
-    antlr4::tree::TerminalNode *NumericIdentifier();
+    antlr4::tree::TerminalNode *IntegerLiteral();
 
 
     virtual std::any accept(antlr4::tree::ParseTreeVisitor *visitor) override;
@@ -323,7 +329,6 @@ public:
 
   class  InitializerContext : public antlr4::ParserRuleContext {
   public:
-    Literal result;
     InitializerContext(antlr4::ParserRuleContext *parent, size_t invokingState);
     virtual size_t getRuleIndex() const override;
     antlr4::tree::TerminalNode *IntegerLiteral();
@@ -456,7 +461,7 @@ public:
     std::unique_ptr<BasicBlock> basicBlockInstance;
     BasicBlockContext(antlr4::ParserRuleContext *parent, size_t invokingState);
     virtual size_t getRuleIndex() const override;
-    antlr4::tree::TerminalNode *Label();
+    antlr4::tree::TerminalNode *NamedIdentifier();
     antlr4::tree::TerminalNode *Colon();
     std::vector<InstructionContext *> instruction();
     InstructionContext* instruction(size_t i);
@@ -533,7 +538,7 @@ public:
     antlr4::tree::TerminalNode *Call();
     TypeContext *type();
     GlobalIdentifierContext *globalIdentifier();
-    FunctionArgumentsContext *functionArguments();
+    CallArgumentsContext *callArguments();
     UnamedIdentifierContext *unamedIdentifier();
     antlr4::tree::TerminalNode *Equals();
 
@@ -544,6 +549,39 @@ public:
 
   CallInstructionContext* callInstruction();
 
+  class  CallArgumentsContext : public antlr4::ParserRuleContext {
+  public:
+    CallArgumentsContext(antlr4::ParserRuleContext *parent, size_t invokingState);
+    virtual size_t getRuleIndex() const override;
+    antlr4::tree::TerminalNode *LeftParen();
+    antlr4::tree::TerminalNode *RightParen();
+    std::vector<CallArgumentContext *> callArgument();
+    CallArgumentContext* callArgument(size_t i);
+    std::vector<antlr4::tree::TerminalNode *> Comma();
+    antlr4::tree::TerminalNode* Comma(size_t i);
+
+
+    virtual std::any accept(antlr4::tree::ParseTreeVisitor *visitor) override;
+   
+  };
+
+  CallArgumentsContext* callArguments();
+
+  class  CallArgumentContext : public antlr4::ParserRuleContext {
+  public:
+    CallArgumentContext(antlr4::ParserRuleContext *parent, size_t invokingState);
+    virtual size_t getRuleIndex() const override;
+    NumberContext *number();
+    TypeContext *type();
+    VariableContext *variable();
+
+
+    virtual std::any accept(antlr4::tree::ParseTreeVisitor *visitor) override;
+   
+  };
+
+  CallArgumentContext* callArgument();
+
   class  ArithmeticInstructionContext : public antlr4::ParserRuleContext {
   public:
     ArithmeticInstructionContext(antlr4::ParserRuleContext *parent, size_t invokingState);
@@ -612,6 +650,8 @@ public:
   public:
     PhiInstructionContext(antlr4::ParserRuleContext *parent, size_t invokingState);
     virtual size_t getRuleIndex() const override;
+    UnamedIdentifierContext *unamedIdentifier();
+    antlr4::tree::TerminalNode *Equals();
     antlr4::tree::TerminalNode *Phi();
     TypeContext *type();
     std::vector<PhiValueContext *> phiValue();
@@ -631,7 +671,7 @@ public:
     PhiValueContext(antlr4::ParserRuleContext *parent, size_t invokingState);
     virtual size_t getRuleIndex() const override;
     antlr4::tree::TerminalNode *LeftBrace();
-    UnamedIdentifierContext *unamedIdentifier();
+    LocalVariableContext *localVariable();
     antlr4::tree::TerminalNode *Comma();
     ValueContext *value();
     antlr4::tree::TerminalNode *RightBrace();
@@ -129,6 +129,14 @@ public:
     return visitChildren(ctx);
   }
 
+  virtual std::any visitCallArguments(LLVMParser::CallArgumentsContext *ctx) override {
+    return visitChildren(ctx);
+  }
+
+  virtual std::any visitCallArgument(LLVMParser::CallArgumentContext *ctx) override {
+    return visitChildren(ctx);
+  }
+
   virtual std::any visitArithmeticInstruction(LLVMParser::ArithmeticInstructionContext *ctx) override {
     return visitChildren(ctx);
   }
@@ -80,6 +80,10 @@ public:
 
     virtual std::any visitCallInstruction(LLVMParser::CallInstructionContext *context) = 0;
 
+    virtual std::any visitCallArguments(LLVMParser::CallArgumentsContext *context) = 0;
+
+    virtual std::any visitCallArgument(LLVMParser::CallArgumentContext *context) = 0;
+
     virtual std::any visitArithmeticInstruction(LLVMParser::ArithmeticInstructionContext *context) = 0;
 
     virtual std::any visitLoadInstruction(LLVMParser::LoadInstructionContext *context) = 0;
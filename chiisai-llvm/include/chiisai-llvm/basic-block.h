@@ -4,16 +4,22 @@
 
 #ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_BASIC_BLOCK_H
 #define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_BASIC_BLOCK_H
+#include <span>
 #include <chiisai-llvm/value.h>
 #include <chiisai-llvm/properties.h>
+#include <chiisai-llvm/mystl/ilist.h>
+#include <chiisai-llvm/mystl/castings.h>
+#include <chiisai-llvm/mystl/small_vector.h>
 namespace llvm {
 
 struct Module;
 struct Instruction;
 struct Function;
 struct InstTransformer;
+struct BrInst;
 struct BasicBlock : Executable {
-  explicit BasicBlock(std::string name) : m_name(std::move(name)) {}
+  // the instructions of the block are placed in the arena of its function
+  explicit BasicBlock(Symbol name, mystl::arena &arena) : m_name(name), m_arena(arena) {}
 
   template<typename Func> requires std::invocable<Func, Ref<Instruction>>
   void forEachInstruction(Func &&func) const {
@@ -21,11 +27,12 @@ struct BasicBlock : Executable {
       func(inst);
   }
 
+  // visits the instructions of one class, which is told by the opcode alone
   template<typename Derived, typename Func> requires std::invocable<Func, Ref<Derived>>
   void forEachInstruction(Func &&func) const {
     for (auto inst : instructions)
-      if (auto derived = dynCast<Derived>(inst))
-        func(derived);
+      if (mystl::isa<Derived>(inst))
+        func(mystl::cast<Derived>(inst));
   }
 
   [[nodiscard]] const Function& function() const {
@@ -43,21 +50,73 @@ struct BasicBlock : Executable {
   [[nodiscard]] CRef<Module> module() const;
 
   [[nodiscard]] const std::string &name() const {
+    return m_name.str();
+  }
+  [[nodiscard]] Symbol symbol() const {
     return m_name;
   }
+  // dense index of the block within its function, see Function::blockIndexBound
+  [[nodiscard]] uint32_t index() const {
+    return m_index;
+  }
 
-  [[nodiscard]] Ref<Value> localResult(const std::string& name) {
-    return m_localResultMap[name];
+  // the results of all blocks share one table in the function, which tells whether a result is in this block
+  [[nodiscard]] Ref<Value> localResult(std::string_view name) const;
+  [[nodiscard]] Ref<Value> localResult(Symbol name) const {
+    return localResult(std::string_view(name.str()));
   }
 
-  BasicBlock& addInstruction(std::unique_ptr<Instruction>&& instruction);
+  /**
+   * @brief the edges of the control flow graph, kept up to date as terminators are linked in, retargeted or erased
+   * there is one entry per edge, so a block branching twice to the same block lists it twice
+   * the successors follow the order of the targets of the terminator, the predecessors come in no particular order
+   * a block that is erased from its function must not be the target of any branch left
+   */
+  [[nodiscard]] std::span<const Ref<BasicBlock>> successors() const {
+    return {m_successors.data(), m_successors.size()};
+  }
+  [[nodiscard]] std::span<const Ref<BasicBlock>> predecessors() const {
+    return {m_predecessors.data(), m_predecessors.size()};
+  }
 
-  mystl::poly_list<Instruction> instructions;
+  // appends a new instruction constructed from args, which include the block itself like every instruction ctor
+  template<typename Inst, typename... Args> requires std::is_base_of_v<Instruction, Inst>
+  Ref<Inst> createInstruction(Args &&... args) {
+    return insertInstruction<Inst>(instructions.end(), std::forward<Args>(args)...);
+  }
+
+  mystl::ilist<Instruction> instructions;
   void accept(Executor &executor) override;
 private:
-  std::string m_name;
-  std::unordered_map<std::string, Ref<Value>> m_localResultMap{};
+  friend struct Function;
+  friend struct InstTransformer;
+  friend struct BrInst;
+  template<typename Inst, typename... Args>
+  Ref<Inst> insertInstruction(mystl::ilist<Instruction>::iterator pos, Args &&... args) {
+    auto inst = m_arena.make<Inst>(std::forward<Args>(args)...);
+    auto instRef = mystl::make_observer(inst.get());
+    adopt(pos, std::move(inst));
+    return instRef;
+  }
+  // links an instruction of the same function in before pos and makes this block its parent
+  void adopt(mystl::ilist<Instruction>::iterator pos, mystl::arena_ptr<Instruction> inst);
+  // unlinks an instruction of this block, it is destroyed unless it is adopted by some block
+  mystl::arena_ptr<Instruction> release(Instruction &inst);
+  // the edges of a terminator of this block, added when it is linked in and removed when it is unlinked
+  void addEdges(const Instruction &inst);
+  void removeEdges(const Instruction &inst);
+  void addSuccessor(BasicBlock &dest);
+  void removeSuccessor(BasicBlock &dest);
+  // rebinds the edge of the target numbered index of the terminator to to, in place,
+  // by position rather than by block, since a terminator may list the same block twice
+  void replaceSuccessor(size_t index, BasicBlock &to);
+  Symbol m_name;
+  uint32_t m_index{};
+  mystl::arena &m_arena;
   Ref<Function> m_function{};
+  // blocks mostly end in a branch to one or two blocks and are reached from one or two
+  mystl::small_vector<Ref<BasicBlock>, 2> m_successors{};
+  mystl::small_vector<Ref<BasicBlock>, 2> m_predecessors{};
 };
 
 }
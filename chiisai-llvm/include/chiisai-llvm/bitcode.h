@@ -0,0 +1,37 @@
+//
+// Created by creeper on 10/18/26.
+//
+
+#ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_BITCODE_H
+#define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_BITCODE_H
+#include <memory>
+#include <cstdint>
+#include <filesystem>
+namespace llvm {
+
+struct Module;
+class LLVMContext;
+
+// bumped whenever the encoding changes, readBitcode rejects files of another version
+constexpr uint32_t BitcodeVersion = 1;
+
+/**
+ * @brief the binary form of a module, which is loaded without any parsing
+ * a file is a header, the index of the functions, the function bodies, the types, the constants, the globals
+ * and the names, all numbers being 32-bit words in the byte order of the host
+ * every entry of the function index has the same size, so the declarations are read without touching any body
+ */
+// materializes every function of the module to write it
+void writeBitcode(Module &module, const std::filesystem::path &path);
+/**
+ * @brief loads a module written by writeBitcode, creating its types and constants in ctx
+ * the file is mapped and only the declarations are built, the body of a function is decoded from the mapping
+ * when it is materialized, i.e. when it is first called, so loading time grows with the code that is run
+ * the module keeps the file mapped, and ctx must outlive it
+ */
+std::unique_ptr<Module> readBitcode(const std::filesystem::path &path, LLVMContext &ctx);
+// whether the file starts like a bitcode file, so that it is worth reading it with readBitcode
+bool isBitcode(const std::filesystem::path &path);
+
+}
+#endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_BITCODE_H
@@ -0,0 +1,34 @@
+//
+// Created by creeper on 10/18/26.
+//
+
+#ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_CLONER_H
+#define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_CLONER_H
+#include <span>
+#include <memory>
+#include <string>
+#include <chiisai-llvm/ref.h>
+namespace llvm {
+
+struct Value;
+struct Function;
+class LLVMContext;
+
+/**
+ * @brief a copy of a function under another name, whose body lives in the arena of the copy
+ * the body is copied in one pass over the instructions, mapping every argument, instruction and block
+ * to its copy by its dense index, so that operands, incoming blocks of phis and branch targets are
+ * rewritten without any lookup, and constants, globals and callees are shared with the original
+ * the copy belongs to the module of the original but is not added to it, and may be optimized on its own
+ */
+std::unique_ptr<Function> cloneFunction(Function &function, const std::string &name, LLVMContext &ctx);
+/**
+ * @brief a copy of a function in which some arguments are replaced by given values, e.g. constants
+ * argValues has one entry per argument, an argument with a value is dropped from the signature of the copy
+ * and its uses refer to the value instead, while an argument with null is kept
+ */
+std::unique_ptr<Function> specializeFunction(Function &function, const std::string &name,
+                                             std::span<const Ref<Value>> argValues, LLVMContext &ctx);
+
+}
+#endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_CLONER_H
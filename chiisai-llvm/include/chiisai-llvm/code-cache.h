@@ -0,0 +1,57 @@
+//
+// Created by creeper on 10/18/26.
+//
+
+#ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_CODE_CACHE_H
+#define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_CODE_CACHE_H
+#include <memory>
+#include <cstdint>
+#include <string_view>
+#include <filesystem>
+#include <chiisai-llvm/properties.h>
+namespace llvm {
+
+struct Module;
+class LLVMContext;
+
+struct CodeCacheStats {
+  size_t hits{};
+  size_t misses{};
+  size_t stores{};
+  // artifacts that were found but could not be read back, e.g. truncated ones
+  size_t rejected{};
+};
+
+/**
+ * @brief an on-disk cache of modules translated from textual IR, shared by every run that uses the same directory
+ * a module is stored as bitcode, see writeBitcode, so a warm start maps it instead of parsing the text again,
+ * and only decodes the bodies of the functions it calls
+ * an artifact is keyed by the FNV-1a hash of the source text, the engine and bitcode versions and the build id,
+ * computed once per source, and is written to a temporary file and renamed into place, so concurrent runs never see a partial file
+ */
+struct CodeCache : NonCopyable {
+  // bumped whenever translation changes, so that artifacts of an older engine are never loaded
+  static constexpr uint32_t EngineVersion = 3;
+  // CHIISAI_LLVM_BUILD_ID if the build defines one, e.g. to keep builds of a patched engine apart, empty otherwise,
+  // so that rebuilding the same engine keeps its artifacts
+  [[nodiscard]] static std::string_view buildId();
+
+  explicit CodeCache(std::filesystem::path directory);
+  CodeCache(CodeCache &&) = delete;
+
+  // the module translated from source in an earlier run, null if there is none, ctx must outlive it
+  [[nodiscard]] std::unique_ptr<Module> load(std::string_view source, LLVMContext &ctx);
+  // the module must have been translated from source, its bodies are materialized to be written
+  void store(std::string_view source, Module &module);
+  [[nodiscard]] const CodeCacheStats &stats() const {
+    return m_stats;
+  }
+private:
+  [[nodiscard]] static uint64_t key(std::string_view source);
+  [[nodiscard]] std::filesystem::path artifactPath(uint64_t key) const;
+  std::filesystem::path m_directory;
+  CodeCacheStats m_stats{};
+};
+
+}
+#endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_CODE_CACHE_H
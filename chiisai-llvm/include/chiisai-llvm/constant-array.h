@@ -4,11 +4,28 @@
 
 #ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_CONSTANT_ARRAY_H
 #define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_CONSTANT_ARRAY_H
+#include <span>
+#include <vector>
 #include <chiisai-llvm/constant.h>
+#include <chiisai-llvm/array-type.h>
 namespace llvm {
 
+/**
+ * @brief an array of constants, shared by every initializer with the same type and elements, see ConstantPool
+ * the elements are themselves unique, so two arrays are equal if and only if they hold the very same elements
+ * elements may be arrays in turn, and an array may list fewer elements than its type holds, the rest being zero
+ */
 struct ConstantArray : Constant {
-
+  ConstantArray(const std::string &name, CRef<ArrayType> type, std::span<const CRef<Constant>> elements)
+      : Constant(Kind::ConstantArray, name, type), m_elements(elements.begin(), elements.end()) {}
+  static bool classof(const Value *value) {
+    return value->kind() == Kind::ConstantArray;
+  }
+  [[nodiscard]] std::span<const CRef<Constant>> elements() const {
+    return m_elements;
+  }
+private:
+  std::vector<CRef<Constant>> m_elements;
 };
 
 }
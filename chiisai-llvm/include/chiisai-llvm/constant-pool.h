@@ -4,22 +4,71 @@
 
 #ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_CONSTANT_POOL_H
 #define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_CONSTANT_POOL_H
-#include <concepts>
+#include <span>
+#include <mutex>
+#include <memory>
+#include <string_view>
+#include <unordered_set>
 #include <chiisai-llvm/properties.h>
-#include <chiisai-llvm/constant.h>
-#include <chiisai-llvm/mystl/poly_vector.h>
+#include <chiisai-llvm/constant-scalar.h>
+#include <chiisai-llvm/constant-array.h>
+#include <chiisai-llvm/mystl/sharded_interner.h>
 namespace llvm {
 
+/**
+ * @brief the unique constants of a context
+ * a scalar is canonicalized into the bits of its value and keyed by its type and those bits,
+ * so "1", "01" and "+1" are one constant, and finding it is a single probe that hashes two integers
+ * an array is keyed by its type and the identity of its elements, so repeated initializers share one array
+ * it may be used from many threads at once, e.g. by function bodies parsed in parallel, see parseAssembly:
+ * scalars are spread over the shards of an interner, while arrays, which only initializers make, share one lock
+ */
 struct ConstantPool : RAII {
-  Ref<Constant> constant(CRef<Type> type, const std::string& str) {
-    if (m_constants.contains({type, str}))
-      return mystl::make_observer(m_constants.at({type, str}).get());
-    m_constants.insert({std::pair{type, str}, std::make_unique<Constant>(str, type)});
-    return mystl::make_observer(m_constants.at({type, str}).get());
+  // parses the literal as a value of the scalar type, throwing if it is not one
+  Ref<ConstantScalar> scalar(CRef<Type> type, std::string_view literal);
+  // the value is truncated to the width of the integer type
+  Ref<ConstantScalar> integer(CRef<Type> type, int64_t value);
+  // the value is rounded to float for the float type
+  Ref<ConstantScalar> floating(CRef<Type> type, double value);
+  Ref<ConstantArray> array(CRef<ArrayType> type, std::span<const CRef<Constant>> elements);
+  [[nodiscard]] size_t size() const {
+    std::lock_guard lock(m_arraysMutex);
+    return m_scalars.size() + m_arrays.size();
   }
 private:
-  using ConstantKey = std::pair<CRef<Type>, std::string>;
-  std::unordered_map<ConstantKey, std::unique_ptr<Constant>> m_constants{};
+  Ref<ConstantScalar> canonical(CRef<Type> type, uint64_t bits);
+
+  struct ScalarKey {
+    uint32_t type;
+    uint64_t bits;
+    bool operator==(const ScalarKey &other) const = default;
+  };
+  struct ScalarKeyHash {
+    size_t operator()(const ScalarKey &key) const;
+  };
+  // arrays are looked up by a view of their type and elements, so a hit builds nothing
+  struct ArrayView {
+    uint32_t type;
+    std::span<const CRef<Constant>> elements;
+  };
+  struct ArrayHash {
+    using is_transparent = void;
+    size_t operator()(const ArrayView &view) const;
+    size_t operator()(const std::unique_ptr<ConstantArray> &array) const;
+  };
+  struct ArrayEqual {
+    using is_transparent = void;
+    bool operator()(const ArrayView &lhs, const std::unique_ptr<ConstantArray> &rhs) const;
+    bool operator()(const std::unique_ptr<ConstantArray> &lhs, const ArrayView &rhs) const {
+      return (*this)(rhs, lhs);
+    }
+    bool operator()(const std::unique_ptr<ConstantArray> &lhs, const std::unique_ptr<ConstantArray> &rhs) const {
+      return lhs == rhs;
+    }
+  };
+  mystl::sharded_interner<ScalarKey, ConstantScalar, ScalarKeyHash> m_scalars{};
+  mutable std::mutex m_arraysMutex{};
+  std::unordered_set<std::unique_ptr<ConstantArray>, ArrayHash, ArrayEqual> m_arrays{};
 };
 
 }
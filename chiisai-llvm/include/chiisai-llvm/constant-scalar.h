@@ -4,11 +4,41 @@
 
 #ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_CONSTANT_SCALAR_H
 #define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_CONSTANT_SCALAR_H
+#include <bit>
+#include <cstdint>
 #include <chiisai-llvm/constant.h>
 namespace llvm {
 
+/**
+ * @brief an integer or floating point constant, stored as the bits of its value
+ * the bits are canonical, see ConstantPool, so two constants of a type are equal if and only if their bits are
+ * and the name is the canonical spelling of the value
+ */
 struct ConstantScalar : Constant {
-  ConstantScalar(const std::string &name, CRef<Type> type) : Constant(name, type) {}
+  ConstantScalar(const std::string &name, CRef<Type> type, uint64_t bits)
+      : Constant(Kind::ConstantScalar, name, type), m_bits(bits) {}
+  static bool classof(const Value *value) {
+    return value->kind() == Kind::ConstantScalar;
+  }
+  // integers are sign-extended from their width except for booleans, which are 0 or 1
+  // a float holds its 32-bit pattern in the low bits, a double its 64-bit pattern
+  [[nodiscard]] uint64_t bits() const {
+    return m_bits;
+  }
+  [[nodiscard]] int64_t intValue() const {
+    return static_cast<int64_t>(m_bits);
+  }
+  [[nodiscard]] bool boolValue() const {
+    return m_bits != 0;
+  }
+  [[nodiscard]] float floatValue() const {
+    return std::bit_cast<float>(static_cast<uint32_t>(m_bits));
+  }
+  [[nodiscard]] double doubleValue() const {
+    return std::bit_cast<double>(m_bits);
+  }
+private:
+  uint64_t m_bits;
 };
 
 }
@@ -8,7 +8,10 @@
 namespace llvm {
 
 struct Constant : User {
-  Constant(const std::string &name, CRef<Type> type) : User(name, type) {}
+  Constant(Kind kind, const std::string &name, CRef<Type> type) : User(kind, name, type) {}
+  static bool classof(const Value *value) {
+    return value->kind() == Kind::ConstantScalar || value->kind() == Kind::ConstantArray;
+  }
 };
 
 }
@@ -4,86 +4,191 @@
 
 #ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_EXECUTOR_H
 #define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_EXECUTOR_H
+#include <span>
+#include <cassert>
 #include <stack>
+#include <functional>
+#include <utility>
+#include <memory>
+#include <optional>
+#include <unordered_map>
 #include <chiisai-llvm/ref.h>
 #include <chiisai-llvm/value.h>
+#include <chiisai-llvm/basic-block.h>
 #include <chiisai-llvm/address.h>
+#include <chiisai-llvm/result.h>
+#include <chiisai-llvm/native-function.h>
+#include <chiisai-llvm/memory-arena.h>
+#include <chiisai-llvm/perf-map.h>
 namespace llvm {
 
-struct Result {
-  using Integer = std::variant<int32_t, int64_t>;
-  using Floating = std::variant<float, double>;
-
-  explicit Result(Integer value) {
-    if (std::holds_alternative<int32_t>(value))
-      this->value = std::get<int32_t>(value);
-    this->value = std::get<int64_t>(value);
-  }
-
-  explicit Result(Floating value) {
-    if (std::holds_alternative<float>(value))
-      this->value = std::get<float>(value);
-    this->value = std::get<double>(value);
-  }
+struct Module;
+struct Function;
+struct BasicBlock;
+struct LLVMContext;
 
-  std::variant<bool, int32_t, int64_t, float, double, Address> value;
-  [[nodiscard]] bool isBool() const {
-    return std::holds_alternative<bool>(value);
-  }
-  [[nodiscard]] bool isPointer() const {
-    return std::holds_alternative<Address>(value);
-  }
-  [[nodiscard]] bool canOperateWith(const Result &other) const {
-    return !isBool() && value.index() == other.value.index() && !std::holds_alternative<Address>(value);
-  }
-  [[nodiscard]] Integer toInteger() const {
-    if (std::holds_alternative<int32_t>(value))
-      return std::get<int32_t>(value);
-    if (std::holds_alternative<int64_t>(value))
-      return std::get<int64_t>(value);
-    throw std::runtime_error("Cannot convert to integer");
-  }
-  [[nodiscard]] Floating toFloating() const {
-    if (std::holds_alternative<float>(value))
-      return std::get<float>(value);
-    if (std::holds_alternative<double>(value))
-      return std::get<double>(value);
-    throw std::runtime_error("Cannot convert to floating point");
-  }
-  Address toPointer() const {
-    return std::get<Address>(value);
+/**
+ * @brief register layout of a function, computed when the function is translated
+ * and again when the function was changed since, as told by its revision
+ * every argument and instruction of the function owns the slot given by its local index,
+ * translation numbers the function canonically, so block indices also give the order of the blocks
+ * and a jump to a block whose index is not greater is a back edge
+ */
+struct FrameLayout {
+  size_t slotCount{};
+  size_t blockCount{};
+  // the revision of the function the layout was computed at
+  uint32_t revision{};
+  std::unordered_map<Symbol, size_t> namedSlots{};
+  [[nodiscard]] size_t size() const {
+    return slotCount;
   }
 };
 
 struct CallFrame {
-  std::unordered_map<std::string, Result> regs;
+  explicit CallFrame(const FrameLayout &layout, MemoryArena::Marker memoryMark)
+      : layout(layout), regs(layout.size()), memoryMark(memoryMark) {}
+  const FrameLayout &layout;
+  std::vector<std::optional<Result>> regs;
+  // memory allocated by alloca after this mark is released together with the frame
+  MemoryArena::Marker memoryMark;
+  std::optional<Result> returnValue{};
+  Ref<BasicBlock> nextBasicBlock{};
 };
 
-struct Module;
-
 struct Executor {
-  explicit Executor(Module &module, LLVMContext &ctx) : module(module), ctx(ctx) {}
+  explicit Executor(Module &module, LLVMContext &ctx, const MemoryArena::Options &memoryOptions = {})
+      : module(module), ctx(ctx), m_memory(memoryOptions) {}
   void execute(Ref<Executable> value) {
     value->accept(*this);
   }
   void execute(Executable &value) {
     value.accept(*this);
   }
-  void pushFrame() {
-    callFrames.emplace();
+
+  /**
+   * @brief translates every function of the module and allocates the data segment
+   * it is done once, calling it again does nothing
+   */
+  Executor &prepare();
+  const FrameLayout &translate(Function &function);
+  /**
+   * @brief names the time spent interpreting each function in profiles taken by perf
+   * see PerfMap, profile with call graphs (perf record -g) to attribute the dispatch loop to its function
+   */
+  Executor &enablePerfMap() {
+    if (!m_perfMap)
+      m_perfMap = std::make_unique<PerfMap>();
+    return *this;
+  }
+
+  /**
+   * @brief calls a function with the given arguments in a fresh frame
+   * @return the returned value, or nullopt if the function returns void
+   */
+  std::optional<Result> call(Function &callee, std::span<const Result> args);
+
+  void pushFrame(Function &function) {
+    callFrames.emplace(translate(function), m_memory.mark());
   }
   void popFrame() {
+    m_memory.release(callFrames.top().memoryMark);
     callFrames.pop();
   }
-  Result &reg(const std::string &name) {
-    return callFrames.top().regs.at(name);
+  const Result &reg(const Value &value);
+  const Result &reg(const std::string &name);
+  void setReg(const Value &value, Result result) {
+    auto &frame = callFrames.top();
+    // a frame pushed before its function was changed has no slots for the new values
+    assert(value.localIndex() < frame.regs.size() && "register out of the frame, the function changed while running");
+    frame.regs[value.localIndex()] = result;
+  }
+
+  void jump(Ref<BasicBlock> dest) {
+    callFrames.top().nextBasicBlock = dest;
+  }
+  void ret(std::optional<Result> value) {
+    auto &frame = callFrames.top();
+    frame.returnValue = value;
+    frame.nextBasicBlock = nullptr;
   }
+  /**
+   * @brief returns the block to run after from, or null if the function has returned
+   * when on-stack replacement is enabled, back edges are counted here and a hot loop header
+   * may continue in the optimized version of the running function
+   */
+  Ref<BasicBlock> takeNextBasicBlock(const BasicBlock &from) {
+    auto &frame = callFrames.top();
+    auto next = std::exchange(frame.nextBasicBlock, nullptr);
+    if (!next || !m_osrCompiler)
+      return next;
+    if (next->index() > from.index())
+      return next;
+    return onBackEdge(next);
+  }
+
+  /**
+   * @brief compiles an optimized version of a function, or returns null if it cannot be optimized
+   * the optimized version must keep the names of the basic blocks and of the values live at loop headers,
+   * which holds for a clone of the function that has been optimized in place
+   */
+  using OsrCompiler = std::function<Ref<Function>(Function &baseline)>;
+  Executor &enableOsr(OsrCompiler compiler, size_t threshold = 1000) {
+    m_osrCompiler = std::move(compiler);
+    m_osrThreshold = threshold;
+    return *this;
+  }
+
+  Address allocate(const Type &type, size_t count);
+  [[nodiscard]] const Result &load(Address address) const {
+    return address.base[address.index];
+  }
+  void store(Address address, const Result &result) {
+    address.base[address.index] = result;
+  }
+  [[nodiscard]] const MemoryStats &memoryStats() const {
+    return m_memory.stats();
+  }
+
+  /**
+   * @brief binds a declared-but-undefined function to a host function
+   * calls to the function are then dispatched to fn with arguments taken directly from the registers
+   * throws if the function has a body or if the host signature does not match the IR signature
+   */
+  template<typename Ret, typename... Params>
+  Executor &bindNative(Function &function, Ret (*fn)(Params...)) {
+    return bindNative(function, NativeFunction::bind(fn));
+  }
+  Executor &bindNative(Function &function, const NativeFunction &native);
+  [[nodiscard]] CRef<NativeFunction> nativeFunction(const Function &function) const {
+    auto it = m_nativeFunctions.find(cref(function));
+    if (it == m_nativeFunctions.end())
+      return nullptr;
+    return cref(it->second);
+  }
+
   Module &module;
   LLVMContext &ctx;
-  std::string incomingBasicBlock{};
+  Symbol incomingBasicBlock{};
 private:
+  void allocateDataSegment();
+  Result *allocateCells(size_t count, const Result &initial);
+  std::optional<Result> invoke(Function &function, std::span<const Result> args);
+  Ref<BasicBlock> onBackEdge(Ref<BasicBlock> header);
+  Ref<Function> optimizedVersion(Function &function);
   std::stack<CallFrame> callFrames;
-  std::unordered_map<std::string, Result> globalResults;
+  OsrCompiler m_osrCompiler{};
+  size_t m_osrThreshold{};
+  std::unordered_map<CRef<BasicBlock>, size_t> m_backEdgeCounts{};
+  // null if the function has been tried and cannot be optimized, or if it is an optimized version itself
+  std::unordered_map<CRef<Function>, Ref<Function>> m_optimizedVersions{};
+  bool m_prepared{};
+  std::unordered_map<CRef<Function>, FrameLayout> m_layouts{};
+  std::unique_ptr<PerfMap> m_perfMap{};
+  // results of the values that do not live in a frame, i.e. constants and addresses of globals
+  std::unordered_map<CRef<Value>, Result> m_nonLocalResults{};
+  MemoryArena m_memory;
+  std::unordered_map<CRef<Function>, NativeFunction> m_nativeFunctions{};
 };
 }
 #endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_EXECUTOR_H
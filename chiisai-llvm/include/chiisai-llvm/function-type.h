@@ -15,6 +15,9 @@ struct FunctionType : Type {
     for (const auto& argType : argTypes)
       containedTypes.emplace_back(argType);
   }
+  static bool classof(const Type *type) {
+    return type->type == TypeEnum::Function;
+  }
   [[nodiscard]] CRef<Type> returnValueType() const { return containedTypes[0]; }
   [[nodiscard]] std::span<const CRef<Type>> argTypes() const { return std::span(containedTypes).subspan<1>(); }
   [[nodiscard]] CRef<Type> argType(size_t index) const { return containedTypes[index + 1]; }
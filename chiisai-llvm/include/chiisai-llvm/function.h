@@ -4,11 +4,15 @@
 
 #ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_FUNCTION_H
 #define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_FUNCTION_H
+#include <list>
 #include <chiisai-llvm/argument.h>
 #include <chiisai-llvm/function-type.h>
 #include <chiisai-llvm/instruction.h>
+#include <chiisai-llvm/hash-cons.h>
+#include <chiisai-llvm/materializer.h>
 #include <chiisai-llvm/mystl/poly_vector.h>
 #include <chiisai-llvm/mystl/manager_vector.h>
+#include <chiisai-llvm/mystl/arena.h>
 namespace llvm {
 
 struct Module;
@@ -21,41 +25,110 @@ struct FunctionInfo {
 
 struct BasicBlock;
 struct Function : Value {
-  explicit Function(const FunctionInfo& info) : Value(info.name, info.functionType), m_module(info.module) {
+private:
+  // basic blocks and instructions live here, so the arena is declared first to be destroyed last
+  mystl::arena m_arena{};
+  // instructions leave the table as they are destroyed, so it is declared before the blocks as well
+  HashConsTable m_hashCons{};
+public:
+  explicit Function(const FunctionInfo& info)
+      : Value(Kind::Function, info.name, info.functionType), basicBlocks(mystl::arena_allocator<BasicBlock>(m_arena)),
+        m_module(info.module) {
     for (size_t i = 0; i < info.argNames.size(); ++i)
       addArgument(info.argNames[i], info.functionType->argType(i));
   }
+  static bool classof(const Value *value) {
+    return value->kind() == Kind::Function;
+  }
   Function& addArgument(const std::string& name, CRef<Type> type) {
     m_args.emplace_back(name, type);
-    m_argMap[name] = m_args.back();
+    m_argMap[m_args.back()->symbol()] = m_args.back();
+    // arguments come first in the canonical numbering
+    if (m_valueIndexBound != m_args.size() - 1)
+      m_numberingCanonical = false;
+    m_args.back()->m_localIndex = m_valueIndexBound++;
+    m_revision++;
     return *this;
   }
   Function& addLocalVar(Ref<AllocaInst> allocaInst) {
     m_localVars.emplace_back(allocaInst);
-    m_localVarMap[allocaInst->name()] = allocaInst;
+    m_localVarMap[allocaInst->symbol()] = allocaInst;
     return *this;
   }
-  Ref<AllocaInst> localVar(const std::string& name) {
-    if (m_localVarMap.contains(name))
-      return m_localVarMap[name];
-    return nullptr;
+  // the lookups by name probe their table once, without going through the symbol table or allocating
+  Ref<AllocaInst> localVar(std::string_view name) const {
+    auto it = m_localVarMap.find(name);
+    return it == m_localVarMap.end() ? nullptr : it->second;
+  }
+  Ref<AllocaInst> localVar(Symbol name) const {
+    return localVar(std::string_view(name.str()));
   }
   [[nodiscard]]
-  Ref<Argument> arg(const std::string& name) {
-    if (m_argMap.contains(name))
-      return m_argMap[name];
-    return nullptr;
+  Ref<Argument> arg(std::string_view name) const {
+    auto it = m_argMap.find(name);
+    return it == m_argMap.end() ? nullptr : it->second;
+  }
+  [[nodiscard]]
+  Ref<Argument> arg(Symbol name) const {
+    return arg(std::string_view(name.str()));
+  }
+  // resolves a local name, i.e. an argument or the result of an instruction in any basic block
+  [[nodiscard]] Ref<Value> lookup(std::string_view name) const;
+  [[nodiscard]] Ref<Value> lookup(Symbol name) const {
+    return lookup(std::string_view(name.str()));
   }
   const mystl::manager_vector<Argument>& args() const { return m_args; }
-  std::list<BasicBlock> basicBlocks{};
+  BasicBlock &addBasicBlock(const std::string &name);
+  std::list<BasicBlock, mystl::arena_allocator<BasicBlock>> basicBlocks;
+  // a function without basic blocks is only declared, its body may be provided by the host
+  [[nodiscard]] bool isDeclaration() const { return basicBlocks.empty() && !m_materializer; }
+  /**
+   * @brief a function may be loaded with its body left to a materializer, which builds it on first use
+   * code that walks the body of a function it did not build itself must materialize the function first
+   */
+  [[nodiscard]] bool isMaterialized() const { return !m_materializer; }
+  void setMaterializer(Ref<Materializer> materializer) { m_materializer = materializer; }
+  // builds the body if it has not been built yet, does nothing otherwise
+  // if building fails, the function is left without a body and is still to be materialized
+  void materialize();
+  // destroys the basic blocks and their instructions, e.g. what was built of a body before building it failed
+  void dropBody();
   [[nodiscard]] const Module& module() const { return m_module; }
+  [[nodiscard]] const mystl::arena& arena() const { return m_arena; }
+  [[nodiscard]] mystl::arena& arena() { return m_arena; }
+  [[nodiscard]] const HashConsTable& hashCons() const { return m_hashCons; }
+  [[nodiscard]] HashConsTable& hashCons() { return m_hashCons; }
+  /**
+   * @brief bounds of the dense indices of the values, i.e. arguments and instructions, and of the basic blocks
+   * every index is below its bound, so a std::vector of the bound size can hold per-value or per-block data
+   * new values and blocks take the next index, and erased instructions leave holes until the function is renumbered
+   */
+  [[nodiscard]] uint32_t valueIndexBound() const { return m_valueIndexBound; }
+  [[nodiscard]] uint32_t blockIndexBound() const { return m_blockIndexBound; }
+  // true if the indices are dense and follow the order of the arguments, the blocks and the instructions in them
+  [[nodiscard]] bool isCanonicallyNumbered() const { return m_numberingCanonical; }
+  // renumbers the function canonically, which invalidates side tables built on the previous numbering
+  void renumber();
+  /**
+   * @brief bumped whenever a value or a block is numbered or a local name is bound or unbound
+   * a side table built on the indices, like the frame layout of the executor, is stale once the revision moves
+   */
+  [[nodiscard]] uint32_t revision() const { return m_revision; }
   void accept(Executor& executor) override;
 private:
+  friend struct BasicBlock;
+  uint32_t m_valueIndexBound{};
+  uint32_t m_blockIndexBound{};
+  bool m_numberingCanonical{true};
+  uint32_t m_revision{};
+  Ref<Materializer> m_materializer{};
   mystl::manager_vector<Argument> m_args{};
   std::vector<Ref<AllocaInst>> m_localVars{};
   const Module& m_module;
-  std::unordered_map<std::string, Ref<Argument>> m_argMap{};
-  std::unordered_map<std::string, Ref<AllocaInst>> m_localVarMap{};
+  SymbolMap<Ref<Argument>> m_argMap{};
+  SymbolMap<Ref<AllocaInst>> m_localVarMap{};
+  // the named results of the instructions of every block, kept by BasicBlock as instructions come and go
+  SymbolMap<Ref<Value>> m_localResults{};
 };
 
 }
@@ -4,21 +4,39 @@
 
 #ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_GLOBAL_VARIABLE_H
 #define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_GLOBAL_VARIABLE_H
+#include <stdexcept>
 #include <chiisai-llvm/constant.h>
 namespace llvm {
 
 struct GlobalVariableDetails {
   const std::string& name;
+  CRef<Type> type;
   CRef<Constant> initializer{};
   bool isConstant{};
 };
 
 struct GlobalVariable : Value {
+  explicit GlobalVariable(const GlobalVariableDetails &details)
+      : Value(Kind::GlobalVariable, details.name, details.type), m_initializer(details.initializer),
+        m_isConstant(details.isConstant) {
+    // the data segment is laid out by the type of the variable, so the initializer must fill exactly that
+    if (m_initializer && m_initializer->type() != type())
+      throw std::runtime_error("the initializer " + m_initializer->name() + " of global variable " + name()
+                                   + " does not have the type of the variable");
+  }
+  static bool classof(const Value *value) {
+    return value->kind() == Kind::GlobalVariable;
+  }
 
   [[nodiscard]] bool isConstant() const {
     return m_isConstant;
   }
+  // null if the variable is zero-initialized
+  [[nodiscard]] CRef<Constant> initializer() const {
+    return m_initializer;
+  }
 private:
+  CRef<Constant> m_initializer{};
   bool m_isConstant{};
 };
 
@@ -0,0 +1,37 @@
+//
+// Created by creeper on 10/18/26.
+//
+
+#ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_HASH_CONS_H
+#define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_HASH_CONS_H
+#include <cstdint>
+#include <unordered_map>
+#include <chiisai-llvm/ref.h>
+#include <chiisai-llvm/properties.h>
+namespace llvm {
+
+struct Instruction;
+
+/**
+ * @brief the hash-consable instructions of a function, keyed by their structural hash
+ * finds an instruction identical to a given one in expected O(1), which is what CSE and GVN are built on,
+ * whether the instruction found dominates the one looked up is for the caller to decide
+ * an instruction leaves the table when it is destroyed, and when one of its operands is rebound,
+ * since that changes its hash, so a pass that rewrites operands inserts the users again afterwards
+ */
+struct HashConsTable : NonCopyable {
+  // an instruction in the table identical to inst other than inst itself, null if there is none
+  [[nodiscard]] Ref<Instruction> find(const Instruction &inst) const;
+  // the instruction in the table identical to inst, which is inst itself if there was none before
+  // instructions that are not hash-consable are never added and are returned as they are
+  Ref<Instruction> insert(Instruction &inst);
+  void erase(Instruction &inst);
+  [[nodiscard]] size_t size() const {
+    return m_instructions.size();
+  }
+private:
+  std::unordered_multimap<uint64_t, Ref<Instruction>> m_instructions{};
+};
+
+}
+#endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_HASH_CONS_H
@@ -4,24 +4,65 @@
 
 #ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_INST_EDITOR_H
 #define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_INST_EDITOR_H
-#include <chiisai-llvm/mystl/poly_list.h>
+#include <chiisai-llvm/mystl/ilist.h>
 #include <chiisai-llvm/basic-block.h>
 #include <chiisai-llvm/instruction.h>
 namespace llvm {
 struct BasicBlock;
 struct Instruction;
 
-using InstPosition = mystl::poly_list<Instruction>::iterator;
+using InstPosition = mystl::ilist<Instruction>::iterator;
+/**
+ * @brief edits the instructions of a basic block in place
+ * instructions are linked to their neighbours, so every edit is O(1) and needs no table of positions
+ * instructions can be moved between blocks of the same function, since they share the arena of the function
+ */
 struct InstTransformer {
-  explicit InstTransformer(BasicBlock &basicBlock) : basicBlock(basicBlock), instructions(basicBlock.instructions) {}
-  InstPosition instPos(Instruction& inst) const {
-    return instPosMap.at(inst.hash());
+  explicit InstTransformer(BasicBlock &basicBlock) : basicBlock(basicBlock) {}
+  [[nodiscard]] InstPosition instPos(Instruction &inst) const {
+    if (&inst.basicBlock() != &basicBlock)
+      throw std::runtime_error("instruction " + inst.name() + " does not belong to basic block " + basicBlock.name());
+    return basicBlock.instructions.iterator_to(inst);
+  }
+
+  // the args are those of the constructor of Inst, which include the block like IRBuilder passes them
+  template<typename Inst, typename... Args> requires std::is_base_of_v<Instruction, Inst>
+  Ref<Inst> createBefore(Instruction &pos, Args &&... args) {
+    return basicBlock.insertInstruction<Inst>(instPos(pos), std::forward<Args>(args)...);
+  }
+  template<typename Inst, typename... Args> requires std::is_base_of_v<Instruction, Inst>
+  Ref<Inst> createAfter(Instruction &pos, Args &&... args) {
+    return basicBlock.insertInstruction<Inst>(++instPos(pos), std::forward<Args>(args)...);
+  }
+
+  // the instruction must have no uses left, e.g. after replacing them with Value::replaceAllUsesWith
+  void erase(Instruction &inst) {
+    if (inst.hasUses())
+      throw std::runtime_error("cannot erase instruction " + inst.name() + " while it is still used");
+    basicBlock.release(inst);
+  }
+  // moves an instruction of any block of the same function right before pos, which is in this block
+  void moveBefore(Instruction &inst, Instruction &pos) {
+    moveTo(inst, instPos(pos));
+  }
+  void moveAfter(Instruction &inst, Instruction &pos) {
+    if (&inst == &pos)
+      return;
+    moveTo(inst, ++instPos(pos));
+  }
+  void moveToEnd(Instruction &inst) {
+    moveTo(inst, basicBlock.instructions.end());
   }
 
 private:
-  BasicBlock & basicBlock;
-  mystl::poly_list<Instruction>& instructions;
-  std::unordered_map<uint64_t, InstPosition> instPosMap{};
+  void moveTo(Instruction &inst, InstPosition pos) {
+    if (&inst.function() != &basicBlock.function())
+      throw std::runtime_error("cannot move instruction " + inst.name() + " out of its function");
+    if (pos != basicBlock.instructions.end() && (*pos).get() == &inst)
+      return;
+    basicBlock.adopt(pos, inst.basicBlock().release(inst));
+  }
+  BasicBlock &basicBlock;
 };
 
 }
@@ -4,16 +4,21 @@
 
 #ifndef CACTRIE_CACT_RIE_INCLUDE_CACT_RIE_LLVM_INSTRUCTIONS_H
 #define CACTRIE_CACT_RIE_INCLUDE_CACT_RIE_LLVM_INSTRUCTIONS_H
-#include <variant>
+#include <algorithm>
 #include <chiisai-llvm/user.h>
 #include <chiisai-llvm/basic-block.h>
 #include <chiisai-llvm/predicate.h>
+#include <chiisai-llvm/integer-type.h>
 #include <chiisai-llvm/mystl/hash.h>
+#include <chiisai-llvm/mystl/small_vector.h>
 namespace llvm {
 
-struct Instruction : User {
+struct Instruction : User, mystl::ilist_node<Instruction> {
   explicit Instruction(uint8_t op, const std::string &name, CRef<Type> type, BasicBlock &basicBlock) :
-      User(name, type), opCode(op), basicBlock(basicBlock) {}
+      User(Kind::Instruction, name, type), opCode(op), m_basicBlock(ref(basicBlock)) {}
+  static bool classof(const Value *value) {
+    return value->kind() == Kind::Instruction;
+  }
   enum TerminatorOps : uint8_t {
     Ret,
     Br,
@@ -66,11 +71,11 @@ struct Instruction : User {
   }
 
   [[nodiscard]] bool isBinary() const {
-    return opCode >= BinaryIDEnd && opCode < LogicalIDEnd;
+    return opCode >= Add && opCode < BinaryIDEnd;
   }
 
   [[nodiscard]] bool isIntBinary() const {
-    return opCode >= Add && opCode < AShr;
+    return opCode >= Add && opCode < FAdd;
   }
 
   [[nodiscard]] bool isFloatBinary() const {
@@ -78,11 +83,11 @@ struct Instruction : User {
   }
 
   [[nodiscard]] bool isLogical() const {
-    return opCode >= LogicalIDEnd && opCode < MemoryIDEnd;
+    return opCode >= And && opCode < LogicalIDEnd;
   }
 
   [[nodiscard]] bool isMemory() const {
-    return opCode >= MemoryIDEnd;
+    return opCode >= Alloca && opCode < MemoryIDEnd;
   }
 
   [[nodiscard]] bool isReflexive() const {
@@ -101,14 +106,62 @@ struct Instruction : User {
     return true;
   }
 
+  [[nodiscard]] const BasicBlock &basicBlock() const {
+    return *m_basicBlock;
+  }
+  [[nodiscard]] BasicBlock &basicBlock() {
+    return *m_basicBlock;
+  }
   [[nodiscard]] const Function &function() const {
-    return basicBlock.function();
+    return m_basicBlock->function();
   }
   [[nodiscard]] Function &function() {
-    return basicBlock.function();
+    return m_basicBlock->function();
+  }
+  /**
+   * @brief a hash of the opcode, the type, the identity of each operand and the attributes of the instruction
+   * the name is left out, so identical computations hash alike, see isIdenticalTo
+   * the hash is computed once and cached until an operand of the instruction is rebound
+   */
+  [[nodiscard]] uint64_t hash() const;
+  // whether other computes the same thing from the very same operands
+  [[nodiscard]] bool isIdenticalTo(const Instruction &other) const;
+  // whether an identical instruction can stand in for this one, i.e. it has no side effects and no identity
+  [[nodiscard]] bool isHashConsable() const {
+    return isBinary() || isLogical() || opCode == ICmp || opCode == FCmp || opCode == Gep;
+  }
+  ~Instruction() override;
+protected:
+  // what the operands leave out, e.g. the predicate of a comparison
+  virtual void hashAttributes(size_t &hashCode) const {}
+  virtual bool sameAttributes(const Instruction &other) const {
+    return true;
+  }
+  // for the classof of instruction classes, which are told apart by their opcodes
+  static bool hasOpCode(const Value *value, uint8_t begin, uint8_t end) {
+    if (!classof(value))
+      return false;
+    auto op = static_cast<const Instruction *>(value)->opCode;
+    return op >= begin && op < end;
+  }
+  static bool hasOpCode(const Value *value, uint8_t op) {
+    return hasOpCode(value, op, op + 1);
   }
-  virtual uint64_t hash() const = 0;
-  BasicBlock &basicBlock;
+  // called by the constructors of instructions for each field holding an operand, in operand order
+  void addOperand(Ref<Value> &slot);
+  // drops the cached hash, and the instruction from the hash-cons table, whose key was the old hash,
+  // also called when an attribute that is hashed changes, e.g. the target of a branch
+  void operandChanged();
+private:
+  friend struct Use;
+  friend struct BasicBlock;
+  friend struct HashConsTable;
+  // kept next to opCode, so that both share the word after the list links
+  bool m_hashConsed{};
+  // 0 until computed
+  mutable uint64_t m_hash{};
+  // changes when the instruction is moved to another block
+  Ref<BasicBlock> m_basicBlock;
 };
 
 struct BinaryInstDetails {
@@ -118,41 +171,62 @@ struct BinaryInstDetails {
 };
 
 struct BinaryInst final : Instruction {
+  static bool classof(const Value *value) {
+    return hasOpCode(value, Add, BinaryIDEnd);
+  }
   explicit BinaryInst(uint8_t op, BasicBlock &basicBlock, const BinaryInstDetails &details) :
       Instruction(op, details.name, details.type, basicBlock), lhs(details.lhs), rhs(details.rhs) {
     assert(op >= Add && op < BinaryIDEnd);
+    addOperand(lhs);
+    addOperand(rhs);
   }
 
   Ref<Value> lhs, rhs;
   void accept(Executor &executor) override;
-  [[nodiscard]] uint64_t hash() const override {
-    uint64_t hashCode = 0;
-    mystl::hash_combine(hashCode, name());
-    mystl::hash_combine(hashCode, opCode);
-    mystl::hash_combine(hashCode, lhs->name());
-    mystl::hash_combine(hashCode, rhs->name());
-    return hashCode;
-  }
 };
 
 struct AllocaInstDetails {
   const std::string &name;
   CRef<Type> type;
-  size_t size;
-  size_t alignment;
+  uint32_t size;
+  uint32_t alignment;
 };
 
 struct AllocaInst : Instruction {
+  static bool classof(const Value *value) {
+    return hasOpCode(value, Alloca);
+  }
   explicit AllocaInst(BasicBlock &basicBlock, const AllocaInstDetails &details) : Instruction(
-      MemoryOps::Alloca, details.name, details.type, basicBlock), alignment(details.alignment) {}
-  size_t alignment{};
-  [[nodiscard]] uint64_t hash() const override {
-    uint64_t hashCode{};
-    mystl::hash_combine(hashCode, name());
-    mystl::hash_combine(hashCode, opCode);
-    mystl::hash_combine(hashCode, alignment);
-    return hashCode;
+      MemoryOps::Alloca, details.name, details.type, basicBlock), m_size(details.size), m_alignment(details.alignment) {}
+  [[nodiscard]] uint32_t size() const {
+    return m_size;
+  }
+  [[nodiscard]] uint32_t alignment() const {
+    return m_alignment;
+  }
+  // both are hashed, so changing them drops the cached hash, see operandChanged
+  void setSize(uint32_t size) {
+    m_size = size;
+    operandChanged();
+  }
+  void setAlignment(uint32_t alignment) {
+    m_alignment = alignment;
+    operandChanged();
+  }
+  void accept(Executor &executor) override;
+protected:
+  void hashAttributes(size_t &hashCode) const override {
+    mystl::hash_combine(hashCode, m_size);
+    mystl::hash_combine(hashCode, m_alignment);
   }
+  bool sameAttributes(const Instruction &other) const override {
+    const auto &alloca = mystl::cast<AllocaInst>(other);
+    return m_size == alloca.m_size && m_alignment == alloca.m_alignment;
+  }
+private:
+  // 32 bits each, since neither the element count nor the alignment of a stack slot gets anywhere near 4G
+  uint32_t m_size{};
+  uint32_t m_alignment{};
 };
 
 struct MemInstDetails {
@@ -161,38 +235,43 @@ struct MemInstDetails {
   Ref<Value> pointer;
 };
 
+struct StoreInstDetails {
+  CRef<Type> type;
+  Ref<Value> value;
+  Ref<Value> pointer;
+};
+
 struct StoreInst : Instruction {
-  explicit StoreInst(BasicBlock &basicBlock, const MemInstDetails &details) : Instruction(MemoryOps::Store,
-                                                                                          details.name,
-                                                                                          details.type,
-                                                                                          basicBlock),
-                                                                              pointer(details.pointer) {}
+  static bool classof(const Value *value) {
+    return hasOpCode(value, Store);
+  }
+  explicit StoreInst(BasicBlock &basicBlock, const StoreInstDetails &details) : Instruction(MemoryOps::Store,
+                                                                                           "",
+                                                                                           details.type,
+                                                                                           basicBlock),
+                                                                               value(details.value),
+                                                                               pointer(details.pointer) {
+    addOperand(value);
+    addOperand(pointer);
+  }
+  Ref<Value> value;
   Ref<Value> pointer;
   void accept(Executor &executor) override;
-  [[nodiscard]] uint64_t hash() const override {
-    uint64_t hashCode{};
-    mystl::hash_combine(hashCode, name());
-    mystl::hash_combine(hashCode, opCode);
-    mystl::hash_combine(hashCode, pointer->name());
-    return hashCode;
-  }
 };
 
 struct LoadInst : Instruction {
+  static bool classof(const Value *value) {
+    return hasOpCode(value, Load);
+  }
   explicit LoadInst(BasicBlock &basicBlock, const MemInstDetails &details) : Instruction(MemoryOps::Load,
                                                                                          details.name,
                                                                                          details.type,
                                                                                          basicBlock),
-                                                                             pointer(details.pointer) {}
+                                                                             pointer(details.pointer) {
+    addOperand(pointer);
+  }
   Ref<Value> pointer;
   void accept(Executor &executor) override;
-  [[nodiscard]] uint64_t hash() const override {
-    uint64_t hashCode{};
-    mystl::hash_combine(hashCode, name());
-    mystl::hash_combine(hashCode, opCode);
-    mystl::hash_combine(hashCode, pointer->name());
-    return hashCode;
-  }
 };
 
 struct PhiValue {
@@ -207,43 +286,72 @@ struct PhiInstDetails {
 };
 
 struct PhiInst final : Instruction {
+  static bool classof(const Value *value) {
+    return hasOpCode(value, Phi);
+  }
   explicit PhiInst(BasicBlock &basicBlock, const PhiInstDetails &details) : Instruction(Instruction::OtherOps::Phi,
                                                                                         details.name,
                                                                                         details.type,
                                                                                         basicBlock),
-                                                                            incomingValues(details.incomingValues) {}
-  std::vector<PhiValue> incomingValues;
+                                                                            m_incomingValues(details.incomingValues) {
+    for (auto &incoming : m_incomingValues)
+      addOperand(incoming.value);
+  }
+  // read only, since the uses point into the storage, which must not grow, see addUse
+  [[nodiscard]] const mystl::small_vector<PhiValue, 2> &incomingValues() const {
+    return m_incomingValues;
+  }
   void accept(Executor &executor) override;
-  [[nodiscard]] uint64_t hash() const override {
-    uint64_t hashCode{};
-    mystl::hash_combine(hashCode, name());
-    mystl::hash_combine(hashCode, opCode);
-    for (auto [basicBlock, val] : incomingValues) {
-      mystl::hash_combine(hashCode, basicBlock->name());
-      mystl::hash_combine(hashCode, val->name());
-    }
-    return hashCode;
+protected:
+  // the incoming values are the operands, the blocks they come from are not
+  void hashAttributes(size_t &hashCode) const override {
+    for (const auto &incoming : m_incomingValues)
+      mystl::hash_combine(hashCode, incoming.basicBlock.get());
+  }
+  bool sameAttributes(const Instruction &other) const override {
+    const auto &phi = mystl::cast<PhiInst>(other);
+    return std::ranges::equal(m_incomingValues, phi.m_incomingValues, {}, &PhiValue::basicBlock, &PhiValue::basicBlock);
   }
+private:
+  // most phis merge two values
+  mystl::small_vector<PhiValue, 2> m_incomingValues;
 };
 
 struct CallInstDetails {
   std::string name;
   CRef<Type> type;
   Function &function;
-  const std::vector<std::string> &realArgs;
+  const std::vector<Ref<Value>> &realArgs;
 };
 
 struct CallInst : Instruction {
+  static bool classof(const Value *value) {
+    return hasOpCode(value, Call);
+  }
   explicit CallInst(BasicBlock &basicBlock, const CallInstDetails &details)
       : Instruction(Instruction::OtherOps::Call,
                     details.name,
                     details.type,
                     basicBlock),
-        function(details.function), realArgs(details.realArgs) {}
+        function(details.function), m_realArgs(details.realArgs) {
+    for (auto &arg : m_realArgs)
+      addOperand(arg);
+  }
   Function &function;
-  std::vector<std::string> realArgs;
+  // read only, since the uses point into the storage, which must not grow, see addUse
+  [[nodiscard]] const mystl::small_vector<Ref<Value>, 4> &realArgs() const {
+    return m_realArgs;
+  }
   void accept(Executor &executor) override;
-  [[nodiscard]] uint64_t hash() const override;
+protected:
+  void hashAttributes(size_t &hashCode) const override {
+    mystl::hash_combine(hashCode, &function);
+  }
+  bool sameAttributes(const Instruction &other) const override {
+    return &function == &mystl::cast<CallInst>(other).function;
+  }
+private:
+  mystl::small_vector<Ref<Value>, 4> m_realArgs;
 };
 
 struct CmpInstDetails {
@@ -254,68 +362,127 @@ struct CmpInstDetails {
 };
 
 struct CmpInst final : Instruction {
+  static bool classof(const Value *value) {
+    return hasOpCode(value, ICmp, FCmp + 1);
+  }
   explicit CmpInst(uint8_t op, BasicBlock &basicBlock, const CmpInstDetails &details)
       : Instruction(op, details.name, Type::boolType(details.ctx), basicBlock),
-        predicate(details.predicate),
         lhs(details.lhs),
-        rhs(details.rhs) {
+        rhs(details.rhs),
+        m_predicate(details.predicate) {
     assert(lhs->type() == rhs->type());
     assert((op == OtherOps::ICmp && lhs->type()->isInteger())
                || (op == OtherOps::FCmp && lhs->type()->isFloatingPoint()));
+    addOperand(lhs);
+    addOperand(rhs);
   }
 
-  Predicate predicate;
   Ref<Value> lhs, rhs;
+  [[nodiscard]] Predicate predicate() const {
+    return m_predicate;
+  }
+  // the predicate is hashed, so changing it drops the cached hash, see operandChanged
+  void setPredicate(Predicate predicate) {
+    m_predicate = predicate;
+    operandChanged();
+  }
   void accept(Executor &executor) override;
-  [[nodiscard]] uint64_t hash() const override {
-    uint64_t hashCode{};
-    mystl::hash_combine(hashCode, name());
-    mystl::hash_combine(hashCode, opCode);
-    mystl::hash_combine(hashCode, lhs->name());
-    mystl::hash_combine(hashCode, rhs->name());
-    mystl::hash_combine(hashCode, predicate);
-    return hashCode;
+protected:
+  void hashAttributes(size_t &hashCode) const override {
+    mystl::hash_combine(hashCode, m_predicate);
+  }
+  bool sameAttributes(const Instruction &other) const override {
+    return m_predicate == mystl::cast<CmpInst>(other).m_predicate;
   }
+private:
+  Predicate m_predicate;
+};
+
+struct RetInstDetails {
+  const LLVMContext &ctx;
+  Ref<Value> value{};
+};
+
+struct RetInst final : Instruction {
+  static bool classof(const Value *value) {
+    return hasOpCode(value, Ret);
+  }
+  explicit RetInst(BasicBlock &basicBlock, const RetInstDetails &details)
+      : Instruction(TerminatorOps::Ret,
+                    "",
+                    details.value ? details.value->type() : Type::voidType(details.ctx),
+                    basicBlock),
+        value(details.value) {
+    if (value)
+      addOperand(value);
+  }
+  // null when returning void
+  Ref<Value> value;
+  void accept(Executor &executor) override;
 };
 
 struct BrInst : Instruction {
+  static bool classof(const Value *value) {
+    return hasOpCode(value, Br);
+  }
   struct Conditional {
-    CRef<Value> cond;
-    CRef<BasicBlock> thenBranch;
-    CRef<BasicBlock> elseBranch;
+    Ref<Value> cond;
+    Ref<BasicBlock> thenBranch;
+    Ref<BasicBlock> elseBranch;
   };
+  explicit BrInst(BasicBlock &basicBlock, const LLVMContext &ctx, Ref<BasicBlock> dest)
+      : Instruction(TerminatorOps::Br, "", Type::voidType(ctx), basicBlock), m_thenBranch(dest) {}
+  explicit BrInst(BasicBlock &basicBlock, const LLVMContext &ctx, const Conditional &conditional)
+      : Instruction(TerminatorOps::Br, "", Type::voidType(ctx), basicBlock),
+        m_cond(conditional.cond), m_thenBranch(conditional.thenBranch), m_elseBranch(conditional.elseBranch) {
+    addOperand(m_cond);
+  }
   [[nodiscard]] bool isConditional() const {
-    return std::holds_alternative<Conditional>(dest);
+    return m_cond != nullptr;
   }
   [[nodiscard]] const BasicBlock &thenBranch() const {
-    if (isConditional())
-      return *std::get<Conditional>(dest).thenBranch;
-    return *std::get<CRef<BasicBlock>>(dest);
+    return *m_thenBranch;
   }
   [[nodiscard]] const BasicBlock &elseBranch() const {
     if (isConditional())
-      return *std::get<Conditional>(dest).elseBranch;
+      return *m_elseBranch;
     throw std::runtime_error("unconditional branch");
   }
   [[nodiscard]] const Value &cond() const {
     if (isConditional())
-      return *std::get<Conditional>(dest).cond;
+      return *m_cond;
     throw std::runtime_error("unconditional branch");
   }
-  void accept(Executor &executor);
-  [[nodiscard]] uint64_t hash() const {
-    uint64_t hashCode{};
-    mystl::hash_combine(hashCode, isConditional());
-    if (isConditional()) {
-      mystl::hash_combine(hashCode, cond().name());
-      mystl::hash_combine(hashCode, thenBranch().name());
-      mystl::hash_combine(hashCode, elseBranch().name());
-    } else
-      mystl::hash_combine(hashCode, std::get<CRef<BasicBlock>>(dest)->name());
-    return hashCode;
+  // the targets, the then branch first, as listed by BasicBlock::successors
+  [[nodiscard]] size_t successorCount() const {
+    return isConditional() ? 2 : 1;
+  }
+  [[nodiscard]] Ref<BasicBlock> successor(size_t index) const {
+    if (index >= successorCount())
+      throw std::runtime_error("branch has no successor " + std::to_string(index));
+    return index == 0 ? m_thenBranch : m_elseBranch;
+  }
+  // retargets the branch, moving the edge of its block from the old target to dest
+  void setSuccessor(size_t index, BasicBlock &dest);
+  void accept(Executor &executor) override;
+protected:
+  // the condition is an operand, the targets are not
+  void hashAttributes(size_t &hashCode) const override {
+    mystl::hash_combine(hashCode, &thenBranch());
+    if (isConditional())
+      mystl::hash_combine(hashCode, &elseBranch());
+  }
+  bool sameAttributes(const Instruction &other) const override {
+    const auto &br = mystl::cast<BrInst>(other);
+    return isConditional() == br.isConditional() && &thenBranch() == &br.thenBranch()
+        && (!isConditional() || &elseBranch() == &br.elseBranch());
   }
 private:
-  std::variant<Conditional, CRef<BasicBlock>> dest;
+  // null for an unconditional branch, which only has a then branch;
+  // three plain fields take less room than a variant of the two forms
+  Ref<Value> m_cond{};
+  Ref<BasicBlock> m_thenBranch;
+  Ref<BasicBlock> m_elseBranch{};
 };
 
 struct GepInstDetails {
@@ -326,23 +493,26 @@ struct GepInstDetails {
 };
 
 struct GepInst : Instruction {
+  static bool classof(const Value *value) {
+    return hasOpCode(value, Gep);
+  }
   explicit GepInst(BasicBlock &basicBlock, const GepInstDetails &details) : Instruction(MemoryOps::Gep,
                                                                                         details.name,
                                                                                         details.type,
                                                                                         basicBlock),
                                                                             pointer(details.pointer),
-                                                                            indices(details.indices) {}
-  [[nodiscard]] uint64_t hash() const override {
-    uint64_t hashCode{};
-    mystl::hash_combine(hashCode, name());
-    mystl::hash_combine(hashCode, opCode);
-    mystl::hash_combine(hashCode, pointer->name());
-    for (auto &index : indices)
-      mystl::hash_combine(hashCode, index->name());
-    return hashCode;
-  }
-  std::vector<Ref<Value>> indices{};
+                                                                            m_indices(details.indices) {
+    addOperand(pointer);
+    for (auto &index : m_indices)
+      addOperand(index);
+  }
   Ref<Value> pointer;
+  // read only, since the uses point into the storage, which must not grow, see addUse
+  [[nodiscard]] const mystl::small_vector<Ref<Value>, 2> &indices() const {
+    return m_indices;
+  }
+private:
+  mystl::small_vector<Ref<Value>, 2> m_indices{};
 };
 
 }
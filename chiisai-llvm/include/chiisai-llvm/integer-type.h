@@ -10,6 +10,9 @@ namespace llvm {
 
 struct IntegerType : Type {
   explicit IntegerType(size_t bitWidth) : Type(TypeEnum::Integer), m_bitWidth(bitWidth) {}
+  static bool classof(const Type *type) {
+    return type->type == TypeEnum::Integer;
+  }
   [[nodiscard]]
   size_t bitWidth() const {
     return m_bitWidth;
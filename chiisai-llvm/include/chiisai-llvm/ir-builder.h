@@ -14,65 +14,49 @@ struct IRBuilder {
 
   CRef<AllocaInst> createAllocaInst(const AllocaInstDetails& details) {
     auto &function = basicBlock.function();
-    auto allocaInst = std::make_unique<AllocaInst>(basicBlock, details);
-    auto instRef = ref(*allocaInst);
+    auto instRef = basicBlock.createInstruction<AllocaInst>(basicBlock, details);
     function.addLocalVar(instRef);
-    basicBlock.addInstruction(std::move(allocaInst));
     return instRef;
   }
 
   CRef<BinaryInst> createBinaryInst(uint8_t op, const BinaryInstDetails &details) {
-    auto binaryInst = std::make_unique<BinaryInst>(op, basicBlock, details);
-    auto instRef = ref(*binaryInst);
-    basicBlock.addInstruction(std::move(binaryInst));
-    addUse(instRef, instRef->lhs);
-    addUse(instRef, instRef->rhs);
-    return instRef;
+    return basicBlock.createInstruction<BinaryInst>(op, basicBlock, details);
   }
 
   CRef<PhiInst> createPhiInst(const PhiInstDetails &details) {
-    auto phiInst = std::make_unique<PhiInst>(basicBlock, details);
-    auto instRef = ref(*phiInst);
-    basicBlock.addInstruction(std::move(phiInst));
-    for (auto &[bb, value] : details.incomingValues)
-      addUse(instRef, value);
-    return instRef;
+    return basicBlock.createInstruction<PhiInst>(basicBlock, details);
   }
 
   CRef<CmpInst> createCmpInst(uint8_t op, const CmpInstDetails &details) {
-    auto cmpInst = std::make_unique<CmpInst>(op, basicBlock, details);
-    auto instRef = ref(*cmpInst);
-    basicBlock.addInstruction(std::move(cmpInst));
-    addUse(instRef, instRef->lhs);
-    addUse(instRef, instRef->rhs);
-    return instRef;
+    return basicBlock.createInstruction<CmpInst>(op, basicBlock, details);
   }
 
   CRef<CallInst> createCallInst(const CallInstDetails &details) {
-    auto callInst = std::make_unique<CallInst>(basicBlock, details);
-    auto instRef = ref(*callInst);
-    basicBlock.addInstruction(std::move(callInst));
-    for (const auto &arg : instRef->realArgs)
-      addUse(instRef, basicBlock.function().arg(arg));
-    return instRef;
+    return basicBlock.createInstruction<CallInst>(basicBlock, details);
   }
 
   CRef<GepInst> createGepInst(const GepInstDetails &details) {
-    auto gepInst = std::make_unique<GepInst>(basicBlock, details);
-    auto instRef = ref(*gepInst);
-    basicBlock.addInstruction(std::move(gepInst));
-    addUse(instRef, instRef->pointer);
-    for (auto &index : instRef->indices)
-      addUse(instRef, index);
-    return instRef;
+    return basicBlock.createInstruction<GepInst>(basicBlock, details);
   }
 
   CRef<LoadInst> createLoadInst(const MemInstDetails &details) {
-    auto loadInst = std::make_unique<LoadInst>(basicBlock, details);
-    auto instRef = ref(*loadInst);
-    basicBlock.addInstruction(std::move(loadInst));
-    addUse(instRef, instRef->pointer);
-    return instRef;
+    return basicBlock.createInstruction<LoadInst>(basicBlock, details);
+  }
+
+  CRef<StoreInst> createStoreInst(const StoreInstDetails &details) {
+    return basicBlock.createInstruction<StoreInst>(basicBlock, details);
+  }
+
+  CRef<RetInst> createRetInst(const RetInstDetails &details) {
+    return basicBlock.createInstruction<RetInst>(basicBlock, details);
+  }
+
+  CRef<BrInst> createBrInst(const LLVMContext &ctx, Ref<BasicBlock> dest) {
+    return basicBlock.createInstruction<BrInst>(basicBlock, ctx, dest);
+  }
+
+  CRef<BrInst> createBrInst(const LLVMContext &ctx, const BrInst::Conditional &conditional) {
+    return basicBlock.createInstruction<BrInst>(basicBlock, ctx, conditional);
   }
 
 private:
@@ -0,0 +1,77 @@
+//
+// Created by creeper on 10/18/26.
+//
+
+#ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_IR_MEM_STATS_H
+#define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_IR_MEM_STATS_H
+#include <array>
+#include <string>
+#include <cstdint>
+#include <string_view>
+namespace llvm {
+
+struct Module;
+struct Function;
+struct Instruction;
+
+/**
+ * @brief the memory taken by the IR of a module, broken down by opcode class, i.e. an --ir-mem-stats report
+ * an instruction costs the size of its most derived class, the use records of its operands,
+ * and the heap storage of its operand list once that list outgrew its inline capacity
+ * functions that are not materialized take no memory for their bodies and are only counted
+ * usage:
+ *   std::cerr << IRMemStats::of(module).str();
+ */
+struct IRMemStats {
+  // the opcode ranges of Instruction, with comparisons, phis and calls falling into Other
+  enum class OpClass : uint8_t {
+    Terminator,
+    Binary,
+    Logical,
+    Memory,
+    Other,
+  };
+  static constexpr size_t OpClassCount = static_cast<size_t>(OpClass::Other) + 1;
+
+  struct Footprint {
+    size_t count{};
+    size_t objectBytes{};
+    size_t useBytes{};
+    size_t spillBytes{};
+    [[nodiscard]] size_t bytes() const {
+      return objectBytes + useBytes + spillBytes;
+    }
+    Footprint &operator+=(const Footprint &other);
+  };
+
+  [[nodiscard]] static OpClass opClass(uint8_t opCode);
+  [[nodiscard]] static std::string_view opClassName(OpClass opClass);
+  // the size of the most derived class of an instruction of the opcode
+  [[nodiscard]] static size_t objectSize(uint8_t opCode);
+
+  [[nodiscard]] static IRMemStats of(const Module &module);
+  void add(const Function &function);
+  void add(const Instruction &inst);
+
+  [[nodiscard]] const Footprint &operator[](OpClass opClass) const {
+    return m_classes[static_cast<size_t>(opClass)];
+  }
+  // the instructions of every class
+  [[nodiscard]] Footprint total() const;
+  // a table with one row per opcode class, followed by the totals of the module
+  [[nodiscard]] std::string str() const;
+
+  size_t functionCount{};
+  size_t lazyFunctionCount{};
+  size_t basicBlockCount{};
+  // the nodes of the block lists
+  size_t basicBlockBytes{};
+  // all that the arenas of the functions handed out, which bounds the bytes of the blocks and instructions
+  size_t arenaBytes{};
+  size_t arenaSlabCount{};
+private:
+  std::array<Footprint, OpClassCount> m_classes{};
+};
+
+}
+#endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_IR_MEM_STATS_H
@@ -12,22 +12,29 @@
 #include <chiisai-llvm/array-type.h>
 #include <chiisai-llvm/pointer-type.h>
 #include <chiisai-llvm/function-type.h>
-#include <chiisai-llvm/constant.h>
+#include <chiisai-llvm/constant-scalar.h>
+#include <chiisai-llvm/constant-array.h>
 namespace llvm {
 
 struct Type;
 struct ArrayType;
 struct PointerType;
 struct TypeSystem;
+struct SymbolTable;
 struct ConstantPool;
 struct IntegerType;
 uint8_t stoinst(std::string_view str);
+// also resolves div, which the grammar uses for both signed integer and floating point division, by the operand type
+uint8_t stoinst(std::string_view str, const Type &operandType);
+// the types, constants and names of a context may be looked up and created from many threads at once,
+// see TypeSystem, ConstantPool and SymbolTable
 class LLVMContext {
 public:
   LLVMContext();
   ~LLVMContext();
   // String to Basic Type
-  [[nodiscard]] CRef<Type> stobt(const std::string& str) const;
+  // String to Basic Type, null if the string does not name one
+  [[nodiscard]] CRef<Type> stobt(std::string_view str) const;
   [[nodiscard]] CRef<ArrayType> arrayType(CRef<Type> elementType, size_t size) const;
   [[nodiscard]] CRef<PointerType> pointerType(CRef<Type> elementType) const;
   [[nodiscard]] CRef<FunctionType> functionType(const std::vector<CRef<Type>>& containedTypes) const;
@@ -37,8 +44,19 @@ public:
   [[nodiscard]] CRef<IntegerType> boolType() const;
   [[nodiscard]] CRef<IntegerType> intType() const;
   [[nodiscard]] CRef<IntegerType> longType() const;
-  [[nodiscard]] Ref<Constant> constant(CRef<Type> type, const std::string& str);
+  // the type numbered id, see Type::id
+  [[nodiscard]] CRef<Type> type(uint32_t id) const;
+  // the names of the values and blocks built in the context, which are freed with it
+  [[nodiscard]] SymbolTable &symbols() const {
+    return *symbolTable;
+  }
+  // constants are unique, see ConstantPool, so equal constants are the same value
+  [[nodiscard]] Ref<Constant> constant(CRef<Type> type, std::string_view literal);
+  [[nodiscard]] Ref<ConstantScalar> intConstant(CRef<Type> type, int64_t value);
+  [[nodiscard]] Ref<ConstantScalar> floatConstant(CRef<Type> type, double value);
+  [[nodiscard]] Ref<ConstantArray> constantArray(CRef<ArrayType> type, std::span<const CRef<Constant>> elements);
 private:
+  std::unique_ptr<SymbolTable> symbolTable{};
   std::unique_ptr<TypeSystem> typeSystem{};
   std::unique_ptr<ConstantPool> constantPool{};
 };
@@ -0,0 +1,62 @@
+//
+// Created by creeper on 10/18/26.
+//
+
+#ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MAPPED_CHAR_STREAM_H
+#define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MAPPED_CHAR_STREAM_H
+#include <string>
+#include <string_view>
+#include <filesystem>
+#include <antlr4-runtime.h>
+#include <chiisai-llvm/mapped-file.h>
+namespace llvm {
+
+/**
+ * @brief a character stream that lexes a mapped file in place, instead of the copy an ANTLRInputStream decodes
+ * the characters are the bytes of the file, which is the same as decoding it for ASCII sources like IR and Cact,
+ * other bytes of UTF-8, e.g. in comments, come as one character each, so only positions in a line shift,
+ * and getText still gives back the bytes as they are in the file
+ * usage:
+ *   MappedCharStream input("foo.ll");
+ *   LLVMLexer lexer(&input);
+ */
+struct MappedCharStream final : antlr4::CharStream {
+  explicit MappedCharStream(const std::filesystem::path &path) : m_file(path), m_name(path.string()) {}
+  // the whole source, e.g. to echo it, without copying it
+  [[nodiscard]] std::string_view text() const {
+    return m_file.text();
+  }
+  // the text of an interval of character indices, e.g. those of a token, without copying it
+  [[nodiscard]] std::string_view view(const antlr4::misc::Interval &interval) const;
+
+  void consume() override;
+  size_t LA(ssize_t i) override;
+  // the whole file stays mapped, so there is nothing to mark
+  ssize_t mark() override {
+    return -1;
+  }
+  void release(ssize_t marker) override {}
+  size_t index() override {
+    return m_position;
+  }
+  void seek(size_t index) override;
+  size_t size() override {
+    return m_file.size();
+  }
+  std::string getSourceName() const override {
+    return m_name;
+  }
+  std::string getText(const antlr4::misc::Interval &interval) override {
+    return std::string(view(interval));
+  }
+  std::string toString() const override {
+    return std::string(text());
+  }
+private:
+  MappedFile m_file;
+  std::string m_name;
+  size_t m_position{};
+};
+
+}
+#endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MAPPED_CHAR_STREAM_H
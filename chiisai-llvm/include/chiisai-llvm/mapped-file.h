@@ -0,0 +1,38 @@
+//
+// Created by creeper on 10/18/26.
+//
+
+#ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MAPPED_FILE_H
+#define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MAPPED_FILE_H
+#include <vector>
+#include <string_view>
+#include <filesystem>
+#include <chiisai-llvm/properties.h>
+namespace llvm {
+
+/**
+ * @brief a read-only view of a whole file, which is mapped where mmap is available and read in once elsewhere
+ * the bytes stay where they are for as long as the file is alive, so views of them can be handed out freely
+ */
+struct MappedFile : RAII {
+  // throws if the file cannot be opened or mapped, an empty file gives an empty view
+  explicit MappedFile(const std::filesystem::path &path);
+  ~MappedFile();
+  [[nodiscard]] const char *data() const {
+    return m_data;
+  }
+  [[nodiscard]] size_t size() const {
+    return m_size;
+  }
+  [[nodiscard]] std::string_view text() const {
+    return {m_data, m_size};
+  }
+private:
+  const char *m_data{""};
+  size_t m_size{};
+  void *m_mapping{};
+  std::vector<char> m_buffer{};
+};
+
+}
+#endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MAPPED_FILE_H
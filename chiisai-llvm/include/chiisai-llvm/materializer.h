@@ -0,0 +1,22 @@
+//
+// Created by creeper on 10/18/26.
+//
+
+#ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MATERIALIZER_H
+#define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MATERIALIZER_H
+namespace llvm {
+
+struct Function;
+
+/**
+ * @brief provides the bodies of functions on demand, e.g. by decoding them from a file only once they are used
+ * a materializer is owned by the module of its functions, see Module::setMaterializer
+ */
+struct Materializer {
+  virtual ~Materializer() = default;
+  // builds the body of a function the materializer was set on, see Function::materialize
+  virtual void materialize(Function &function) = 0;
+};
+
+}
+#endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MATERIALIZER_H
@@ -0,0 +1,85 @@
+//
+// Created by creeper on 10/18/26.
+//
+
+#ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MEMORY_ARENA_H
+#define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MEMORY_ARENA_H
+#include <cstddef>
+#include <vector>
+#include <chiisai-llvm/properties.h>
+namespace llvm {
+
+struct MemoryStats {
+  size_t reservedBytes{};
+  size_t usedBytes{};
+  size_t peakUsedBytes{};
+  size_t allocations{};
+  size_t regions{};
+  // regions backed by explicitly reserved huge pages (MAP_HUGETLB)
+  size_t hugeTlbRegions{};
+  // regions advised to use transparent huge pages (MADV_HUGEPAGE)
+  size_t transparentHugePageRegions{};
+  // regions that could not be mapped and were taken from the heap instead
+  size_t heapRegions{};
+  size_t hugePageBytes{};
+};
+
+/**
+ * @brief the memory the executor hands out to global and local variables
+ * memory is reserved in large regions with mmap, regions big enough to hold huge pages try explicit huge pages
+ * first, then transparent huge pages, and fall back to normal pages or finally to the heap
+ * allocation is a bump of the current region, and memory is released in stack order through markers,
+ * so a call frame releases everything it allocated by restoring the marker taken when it was pushed
+ */
+struct MemoryArena : NonCopyable {
+  static constexpr size_t HugePageSize = size_t{2} << 20;
+
+  struct Options {
+    size_t regionSize = size_t{64} << 20;
+    bool explicitHugePages = true;
+    bool transparentHugePages = true;
+  };
+
+  struct Marker {
+    size_t region{};
+    size_t offset{};
+  };
+
+  MemoryArena() : MemoryArena(Options{}) {}
+  explicit MemoryArena(const Options &options) : m_options(options) {}
+  MemoryArena(MemoryArena &&) = delete;
+  ~MemoryArena();
+
+  void *allocate(size_t bytes, size_t alignment);
+  [[nodiscard]] Marker mark() const {
+    if (m_regions.empty())
+      return {};
+    return {.region = m_current, .offset = m_regions[m_current].offset};
+  }
+  // frees everything allocated after the marker was taken, the regions are kept for reuse
+  void release(Marker marker);
+  [[nodiscard]] const MemoryStats &stats() const {
+    return m_stats;
+  }
+private:
+  enum class Backing {
+    HugeTlb,
+    TransparentHugePages,
+    Pages,
+    Heap,
+  };
+  struct Region {
+    std::byte *base{};
+    size_t size{};
+    size_t offset{};
+    Backing backing{};
+  };
+  Region reserve(size_t bytes);
+  Options m_options;
+  std::vector<Region> m_regions{};
+  size_t m_current{};
+  MemoryStats m_stats{};
+};
+
+}
+#endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MEMORY_ARENA_H
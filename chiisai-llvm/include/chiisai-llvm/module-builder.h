@@ -4,14 +4,17 @@
 
 #ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MODULE_BUILDER_H
 #define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MODULE_BUILDER_H
+#include <unordered_map>
 #include <chiisai-llvm/function.h>
+#include <chiisai-llvm/argument.h>
 #include <chiisai-llvm/ir-builder.h>
-#include <chiisai-llvm/autogen/LLVMParserVisitor.h>
+#include <chiisai-llvm/autogen/LLVMParserBaseVisitor.h>
 namespace llvm {
 struct Module;
 struct LLVMContext;
 
-struct ModuleBuilder : public LLVMParserVisitor {
+// the rules it does not visit itself are read by the visitors of the rules they are part of
+struct ModuleBuilder : public LLVMParserBaseVisitor {
   std::any visitType(LLVMParser::TypeContext *ctx) override;
 
   std::any visitBasicType(LLVMParser::BasicTypeContext *ctx) override;
@@ -22,17 +25,14 @@ struct ModuleBuilder : public LLVMParserVisitor {
 
   std::any visitModule(LLVMParser::ModuleContext *ctx) override;
 
-  std::any visitGlobalDeclaration(LLVMParser::GlobalDeclarationContext *ctx) override {
-    visitType(ctx->type());
-    auto varType = ctx->type()->typeRef;
-    std::string name = variableName(ctx->globalIdentifier());
-    return {};
-  }
+  std::any visitGlobalDeclaration(LLVMParser::GlobalDeclarationContext *ctx) override;
 
   std::any visitFunctionDefinition(LLVMParser::FunctionDefinitionContext *ctx) override;
 
   std::any visitFunctionArguments(LLVMParser::FunctionArgumentsContext *ctx) override {
     auto params = ctx->parameterList();
+    if (!params)
+      return {};
     visitParameterList(params);
     ctx->argNames = std::move(params->argNames);
     ctx->argTypes = std::move(params->argTypes);
@@ -75,8 +75,32 @@ struct ModuleBuilder : public LLVMParserVisitor {
       visitStoreInstruction(ctx->storeInstruction());
     if (ctx->gepInstruction())
       visitGepInstruction(ctx->gepInstruction());
+    if (ctx->phiInstruction())
+      visitPhiInstruction(ctx->phiInstruction());
+    if (ctx->callInstruction())
+      visitCallInstruction(ctx->callInstruction());
+    if (ctx->terminatorInstruction())
+      visitTerminatorInstruction(ctx->terminatorInstruction());
+    bindForwardRef();
+    return {};
+  }
+
+  std::any visitTerminatorInstruction(LLVMParser::TerminatorInstructionContext *ctx) override {
+    if (ctx->returnInstruction())
+      visitReturnInstruction(ctx->returnInstruction());
+    if (ctx->branchInstruction())
+      visitBranchInstruction(ctx->branchInstruction());
+    return {};
   }
 
+  std::any visitReturnInstruction(LLVMParser::ReturnInstructionContext *ctx) override;
+
+  std::any visitBranchInstruction(LLVMParser::BranchInstructionContext *ctx) override;
+
+  std::any visitPhiInstruction(LLVMParser::PhiInstructionContext *ctx) override;
+
+  std::any visitCallInstruction(LLVMParser::CallInstructionContext *ctx) override;
+
   std::any visitLoadInstruction(LLVMParser::LoadInstructionContext *ctx) override;
 
   std::any visitStoreInstruction(LLVMParser::StoreInstructionContext *ctx) override;
@@ -87,6 +111,7 @@ struct ModuleBuilder : public LLVMParserVisitor {
 
   std::any visitVariable(LLVMParser::VariableContext *ctx) override {
     ctx->isGlobal = ctx->globalIdentifier() != nullptr;
+    ctx->name = ctx->getText();
     return {};
   }
 
@@ -98,7 +123,15 @@ struct ModuleBuilder : public LLVMParserVisitor {
   Ref<Function> currentFunction{};
   Ref<BasicBlock> currentBasicBlock{};
 private:
-  Ref<Value> resolveValueUsage(LLVMParser::ValueContext *ctx);
+  void declareFunction(LLVMParser::FunctionDefinitionContext *ctx);
+  // with a type, a local that is not defined yet is stood in for until its definition is built
+  Ref<Value> resolveValueUsage(LLVMParser::ValueContext *ctx, CRef<Type> type = nullptr);
+  Ref<Value> resolveVariableUsage(LLVMParser::VariableContext *ctx, CRef<Type> type = nullptr);
+  Ref<BasicBlock> resolveBasicBlock(LLVMParser::LocalVariableContext *ctx) const;
+  void bindForwardRef();
+  // the blocks of the function being built, all of which are created before its instructions
+  std::unordered_map<std::string, Ref<BasicBlock>> basicBlocks{};
+  std::unordered_map<std::string, std::unique_ptr<Argument>> forwardRefs{};
   template <typename T>
   std::string variableName(T* ctx) {
     return ctx->getText();
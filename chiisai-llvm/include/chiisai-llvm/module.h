@@ -6,9 +6,12 @@
 #define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MODULE_H
 
 #include <string>
+#include <string_view>
+#include <stdexcept>
 #include <chiisai-llvm/ref.h>
 #include <chiisai-llvm/mystl/manager_vector.h>
 #include <chiisai-llvm/global-variable.h>
+#include <chiisai-llvm/materializer.h>
 namespace llvm {
 struct GlobalVariable;
 struct Function;
@@ -19,24 +22,46 @@ struct Module : Executable {
   }
   mystl::manager_vector<GlobalVariable> globalVariables;
   mystl::manager_vector<Function> functions;
-  Ref<GlobalVariable> globalVariable(const std::string& name) {
-    return m_globalVariableMap.at(name);
+  // throws if there is no such global variable, which hasGlobalVar tells beforehand
+  Ref<GlobalVariable> globalVariable(std::string_view name) const {
+    auto it = m_globalVariableMap.find(name);
+    if (it == m_globalVariableMap.end())
+      throw std::runtime_error("no global variable named " + std::string(name));
+    return it->second;
   }
-  Ref<Function> function(const std::string& name) {
-    return m_functionMap.at(name);
+  Ref<GlobalVariable> globalVariable(Symbol name) const {
+    return globalVariable(std::string_view(name.str()));
   }
-  bool hasFunction(const std::string& name) {
+  // throws if there is no such function, which hasFunction tells beforehand
+  Ref<Function> function(std::string_view name) const {
+    auto it = m_functionMap.find(name);
+    if (it == m_functionMap.end())
+      throw std::runtime_error("no function named " + std::string(name));
+    return it->second;
+  }
+  Ref<Function> function(Symbol name) const {
+    return function(std::string_view(name.str()));
+  }
+  [[nodiscard]] bool hasFunction(std::string_view name) const {
     return m_functionMap.contains(name);
   }
-  bool hasGlobalVar(const std::string& name) {
+  [[nodiscard]] bool hasGlobalVar(std::string_view name) const {
     return m_globalVariableMap.contains(name);
   }
   Module& addFunction(std::unique_ptr<Function>&& function);
+  Module& addGlobalVariable(std::unique_ptr<GlobalVariable>&& globalVariable);
+  // keeps the materializer of the functions alive as long as the module, see Function::materialize
+  void setMaterializer(std::unique_ptr<Materializer> materializer) {
+    m_materializer = std::move(materializer);
+  }
+  // materializes every function, for code that walks all of the module
+  void materializeAll();
   void accept(Executor &executor) override;
 private:
-  std::unordered_map<std::string, Ref<GlobalVariable>> m_globalVariableMap;
-  std::unordered_map<std::string, Ref<Function>> m_functionMap;
+  SymbolMap<Ref<GlobalVariable>> m_globalVariableMap;
+  SymbolMap<Ref<Function>> m_functionMap;
   std::string m_name;
+  std::unique_ptr<Materializer> m_materializer{};
 };
 
 }
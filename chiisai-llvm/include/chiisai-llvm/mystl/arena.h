@@ -0,0 +1,105 @@
+//
+// Created by creeper on 10/18/26.
+//
+
+#ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MYSTL_ARENA_H
+#define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MYSTL_ARENA_H
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+namespace llvm::mystl {
+
+/**
+ * @brief destroys an object placed in an arena without freeing its memory
+ * it is not templated, so an arena_ptr<Derived> converts to an arena_ptr<Base> like a unique_ptr does
+ */
+struct arena_delete {
+  template<typename T>
+  void operator()(T *ptr) const {
+    std::destroy_at(ptr);
+  }
+};
+
+template<typename T>
+using arena_ptr = std::unique_ptr<T, arena_delete>;
+
+/**
+ * @brief a bump allocator that hands out memory from large slabs and frees all of it at once when destroyed
+ * objects are still destroyed one by one through arena_ptr, only their memory is reclaimed in bulk,
+ * so everything placed in an arena must be destroyed before the arena is
+ * the slabs start small and double up to slab_size, since a module has an arena per function and most functions are small
+ */
+struct arena {
+  static constexpr size_t slab_size = size_t{64} << 10;
+  static constexpr size_t first_slab_size = size_t{4} << 10;
+
+  arena() = default;
+  arena(const arena &) = delete;
+  arena &operator=(const arena &) = delete;
+
+  void *allocate(size_t bytes, size_t alignment) {
+    bytes_allocated += bytes;
+    // large objects get a slab of their own, kept before the current slab so that it keeps serving small ones
+    if (bytes > slab_size / 4) {
+      auto position = slabs.empty() ? slabs.end() : slabs.end() - 1;
+      return align(slabs.emplace(position, std::make_unique_for_overwrite<std::byte[]>(bytes + alignment))->get(), alignment);
+    }
+    auto address = reinterpret_cast<uintptr_t>(current);
+    auto aligned = (address + alignment - 1) & ~(alignment - 1);
+    if (!current || aligned + bytes > reinterpret_cast<uintptr_t>(limit)) {
+      auto size = std::max(next_slab_size, bytes + alignment);
+      next_slab_size = std::min(next_slab_size * 2, slab_size);
+      // left uninitialized, so that the pages of a slab are only touched as it fills up
+      current = slabs.emplace_back(std::make_unique_for_overwrite<std::byte[]>(size)).get();
+      limit = current + size;
+      aligned = reinterpret_cast<uintptr_t>(align(current, alignment));
+    }
+    current = reinterpret_cast<std::byte *>(aligned + bytes);
+    return reinterpret_cast<void *>(aligned);
+  }
+
+  template<typename T, typename... Args>
+  arena_ptr<T> make(Args &&... args) {
+    return arena_ptr<T>(new(allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...));
+  }
+
+  [[nodiscard]] size_t slab_count() const {
+    return slabs.size();
+  }
+  size_t bytes_allocated{};
+private:
+  static void *align(std::byte *ptr, size_t alignment) {
+    auto address = reinterpret_cast<uintptr_t>(ptr);
+    return reinterpret_cast<void *>((address + alignment - 1) & ~(alignment - 1));
+  }
+  std::vector<std::unique_ptr<std::byte[]>> slabs{};
+  std::byte *current{};
+  std::byte *limit{};
+  size_t next_slab_size{first_slab_size};
+};
+
+/**
+ * @brief a standard allocator drawing from an arena, deallocation is a no-op
+ * used for the nodes of containers whose elements live as long as the arena
+ */
+template<typename T>
+struct arena_allocator {
+  using value_type = T;
+  explicit arena_allocator(arena &storage) : storage(&storage) {}
+  template<typename U>
+  arena_allocator(const arena_allocator<U> &other) : storage(other.storage) {}
+  T *allocate(size_t n) {
+    return static_cast<T *>(storage->allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T *, size_t) {}
+  template<typename U>
+  bool operator==(const arena_allocator<U> &other) const {
+    return storage == other.storage;
+  }
+  arena *storage;
+};
+
+}
+#endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MYSTL_ARENA_H
@@ -4,12 +4,68 @@
 
 #ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MYSTL_CASTINGS_H
 #define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MYSTL_CASTINGS_H
+#include <cassert>
+#include <type_traits>
 #include "observer_ptr.h"
 namespace llvm::mystl {
 
-template <typename Base, typename Derived>
-observer_ptr<Derived> dynCast(observer_ptr<Base> base) {
-  return make_observer(dynamic_cast<Derived>(base.get()));
+template<typename T>
+inline constexpr bool is_observer_ptr_v = false;
+template<typename T>
+inline constexpr bool is_observer_ptr_v<observer_ptr<T>> = true;
+// an object itself rather than a pointer to it, for the overloads taking references
+template<typename T>
+concept castable_object = !std::is_pointer_v<T> && !is_observer_ptr_v<std::remove_cv_t<T>>;
+
+/**
+ * @brief casts within a class hierarchy that tags its objects with a kind, without any RTTI
+ * a class To takes part by declaring static bool classof(const Base *), which tells from the tag whether
+ * an object of the base is a To, so isa is a compare of the tag and cast is a static_cast
+ * upcasts need no classof, and const is carried over from the source to the result
+ */
+template<typename To, typename From>
+bool isa(const From *from) {
+  assert(from && "isa on a null pointer");
+  if constexpr (std::is_base_of_v<To, From>)
+    return true;
+  else
+    return To::classof(from);
+}
+template<typename To, castable_object From>
+bool isa(const From &from) {
+  return isa<To>(&from);
+}
+template<typename To, typename From>
+bool isa(observer_ptr<From> from) {
+  return isa<To>(from.get());
+}
+
+template<typename To, typename From>
+using cast_result_t = std::conditional_t<std::is_const_v<From>, const To, To>;
+
+// the object must be a To
+template<typename To, typename From>
+cast_result_t<To, From> *cast(From *from) {
+  assert(isa<To>(from) && "cast to a class the object is not an instance of");
+  return static_cast<cast_result_t<To, From> *>(from);
+}
+template<typename To, castable_object From>
+cast_result_t<To, From> &cast(From &from) {
+  return *cast<To>(&from);
+}
+template<typename To, typename From>
+observer_ptr<cast_result_t<To, From>> cast(observer_ptr<From> from) {
+  return make_observer(cast<To>(from.get()));
+}
+
+// null if the object is not a To, or if there is no object to begin with
+template<typename To, typename From>
+cast_result_t<To, From> *dyn_cast(From *from) {
+  return from && isa<To>(from) ? static_cast<cast_result_t<To, From> *>(from) : nullptr;
+}
+template<typename To, typename From>
+observer_ptr<cast_result_t<To, From>> dyn_cast(observer_ptr<From> from) {
+  return make_observer(dyn_cast<To>(from.get()));
 }
 
 template <typename S, typename T>
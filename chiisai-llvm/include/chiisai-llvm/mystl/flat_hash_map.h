@@ -0,0 +1,213 @@
+//
+// Created by creeper on 10/18/26.
+//
+
+#ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MYSTL_FLAT_HASH_MAP_H
+#define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MYSTL_FLAT_HASH_MAP_H
+#include <bit>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <concepts>
+#include <functional>
+namespace llvm::mystl {
+
+// whether a hash and an equality accept other types of keys than the key type of a map, see flat_hash_map
+template<typename Hash, typename KeyEqual>
+concept transparent_lookup = requires {
+  typename Hash::is_transparent;
+  typename KeyEqual::is_transparent;
+};
+
+/**
+ * @brief a hash map that keeps its entries in one array and resolves collisions by linear probing
+ * a find is one walk over adjacent slots, each slot being told apart by a byte of the hash before its key is compared
+ * if both Hash and KeyEqual declare is_transparent, find, contains and erase take any key they accept,
+ * e.g. a std::string_view for a map keyed by names, so that looking up needs no key to be built
+ * keys and values must be default constructible, since the slots hold them whether they are used or not,
+ * and inserting or erasing moves the entries, so pointers and iterators into the map do not survive either
+ */
+template<typename Key, typename T, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+struct flat_hash_map {
+  using value_type = std::pair<Key, T>;
+
+  template<bool Const>
+  struct basic_iterator {
+    using map_type = std::conditional_t<Const, const flat_hash_map, flat_hash_map>;
+    using reference = std::conditional_t<Const, const value_type &, value_type &>;
+    basic_iterator(map_type *map, size_t index) : map(map), index(index) {
+      skip_empty();
+    }
+    reference operator*() const {
+      return map->m_slots[index];
+    }
+    auto operator->() const {
+      return &map->m_slots[index];
+    }
+    basic_iterator &operator++() {
+      index++;
+      skip_empty();
+      return *this;
+    }
+    bool operator==(const basic_iterator &other) const {
+      return index == other.index;
+    }
+  private:
+    void skip_empty() {
+      while (index < map->m_tags.size() && map->m_tags[index] == empty_tag)
+        index++;
+    }
+    map_type *map;
+    size_t index;
+  };
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  flat_hash_map() = default;
+
+  iterator begin() {
+    return iterator(this, 0);
+  }
+  iterator end() {
+    return iterator(this, m_tags.size());
+  }
+  const_iterator begin() const {
+    return const_iterator(this, 0);
+  }
+  const_iterator end() const {
+    return const_iterator(this, m_tags.size());
+  }
+  [[nodiscard]] size_t size() const {
+    return m_size;
+  }
+  [[nodiscard]] bool empty() const {
+    return m_size == 0;
+  }
+
+  template<typename K = Key> requires std::same_as<K, Key> || transparent_lookup<Hash, KeyEqual>
+  iterator find(const K &key) {
+    return iterator(this, find_index(key));
+  }
+  template<typename K = Key> requires std::same_as<K, Key> || transparent_lookup<Hash, KeyEqual>
+  const_iterator find(const K &key) const {
+    return const_iterator(this, find_index(key));
+  }
+  template<typename K = Key> requires std::same_as<K, Key> || transparent_lookup<Hash, KeyEqual>
+  [[nodiscard]] bool contains(const K &key) const {
+    return find_index(key) != m_tags.size();
+  }
+
+  // inserts a value constructed from args unless the key is present, in a single probe either way
+  template<typename... Args>
+  std::pair<iterator, bool> try_emplace(const Key &key, Args &&... args) {
+    reserve(m_size + 1);
+    auto hashed = hash_of(key);
+    auto index = home(hashed);
+    auto tag = tag_of(hashed);
+    for (;; index = (index + 1) & mask()) {
+      if (m_tags[index] == empty_tag)
+        break;
+      if (m_tags[index] == tag && m_equal(m_slots[index].first, key))
+        return {iterator(this, index), false};
+    }
+    m_tags[index] = tag;
+    m_slots[index] = value_type(key, T(std::forward<Args>(args)...));
+    m_size++;
+    return {iterator(this, index), true};
+  }
+  T &operator[](const Key &key) {
+    return try_emplace(key).first->second;
+  }
+
+  // fills the hole by shifting back the entries after it, so lookups never have to skip over deleted slots
+  template<typename K = Key> requires std::same_as<K, Key> || transparent_lookup<Hash, KeyEqual>
+  size_t erase(const K &key) {
+    auto index = find_index(key);
+    if (index == m_tags.size())
+      return 0;
+    for (auto next = (index + 1) & mask(); m_tags[next] != empty_tag; next = (next + 1) & mask()) {
+      // an entry can move back to the hole only if its home slot is not after the hole
+      auto distance = (next - home(hash_of(m_slots[next].first))) & mask();
+      if (distance < ((next - index) & mask()))
+        continue;
+      m_tags[index] = m_tags[next];
+      m_slots[index] = std::move(m_slots[next]);
+      index = next;
+    }
+    m_tags[index] = empty_tag;
+    m_slots[index] = value_type{};
+    m_size--;
+    return 1;
+  }
+  void clear() {
+    m_tags.clear();
+    m_slots.clear();
+    m_size = 0;
+  }
+  // makes room for count entries without rehashing
+  void reserve(size_t count) {
+    if (count * max_load_den <= m_tags.size() * max_load_num)
+      return;
+    auto capacity = std::bit_ceil(std::max<size_t>(min_capacity, count * max_load_den / max_load_num + 1));
+    rehash(capacity);
+  }
+
+private:
+  static constexpr uint8_t empty_tag = 0;
+  static constexpr size_t min_capacity = 8;
+  // at most 7 of 8 slots are used, which keeps the probe sequences short
+  static constexpr size_t max_load_num = 7;
+  static constexpr size_t max_load_den = 8;
+
+  [[nodiscard]] size_t mask() const {
+    return m_tags.size() - 1;
+  }
+  // the hash is mixed, so that hashes that are merely ids still spread over the whole table
+  template<typename K>
+  [[nodiscard]] uint64_t hash_of(const K &key) const {
+    return static_cast<uint64_t>(m_hash(key)) * 0x9e3779b97f4a7c15ull;
+  }
+  [[nodiscard]] size_t home(uint64_t hashed) const {
+    return static_cast<size_t>(hashed >> 32) & mask();
+  }
+  static uint8_t tag_of(uint64_t hashed) {
+    return static_cast<uint8_t>(0x80 | (hashed & 0x7f));
+  }
+
+  template<typename K>
+  [[nodiscard]] size_t find_index(const K &key) const {
+    if (m_size == 0)
+      return m_tags.size();
+    auto hashed = hash_of(key);
+    auto tag = tag_of(hashed);
+    for (auto index = home(hashed); m_tags[index] != empty_tag; index = (index + 1) & mask())
+      if (m_tags[index] == tag && m_equal(m_slots[index].first, key))
+        return index;
+    return m_tags.size();
+  }
+
+  void rehash(size_t capacity) {
+    auto tags = std::exchange(m_tags, std::vector<uint8_t>(capacity, empty_tag));
+    auto slots = std::exchange(m_slots, std::vector<value_type>(capacity));
+    for (size_t i = 0; i < tags.size(); i++) {
+      if (tags[i] == empty_tag)
+        continue;
+      auto index = home(hash_of(slots[i].first));
+      while (m_tags[index] != empty_tag)
+        index = (index + 1) & mask();
+      m_tags[index] = tags[i];
+      m_slots[index] = std::move(slots[i]);
+    }
+  }
+
+  std::vector<uint8_t> m_tags{};
+  std::vector<value_type> m_slots{};
+  size_t m_size{};
+  [[no_unique_address]] Hash m_hash{};
+  [[no_unique_address]] KeyEqual m_equal{};
+};
+
+}
+#endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MYSTL_FLAT_HASH_MAP_H
@@ -7,10 +7,22 @@
 
 #include <functional>
 #include <vector>
+#include <cstdint>
+#include <string_view>
 namespace llvm::mystl {
 template<typename T>
 struct hash {};
 
+// FNV-1a, whose values are specified, unlike those of std::hash, so they may be stored and compared across builds
+// a hash of several pieces is taken by passing the hash of the ones before as the basis of the next
+constexpr uint64_t fnv1a(std::string_view bytes, uint64_t basis = 0xcbf29ce484222325ull) {
+  for (auto byte : bytes) {
+    basis ^= static_cast<uint8_t>(byte);
+    basis *= 0x100000001b3ull;
+  }
+  return basis;
+}
+
 template <typename T>
 inline void hash_combine(std::size_t& seed, const T& value) {
   std::hash<T> hasher;
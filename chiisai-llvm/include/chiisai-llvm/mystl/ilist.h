@@ -0,0 +1,145 @@
+//
+// Created by creeper on 10/18/26.
+//
+
+#ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MYSTL_ILIST_H
+#define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MYSTL_ILIST_H
+#include <cstddef>
+#include "observer_ptr.h"
+#include "arena.h"
+namespace llvm::mystl {
+
+template<typename T>
+struct ilist;
+
+/**
+ * @brief the links an object needs to be an element of an ilist, inherited by the element type
+ */
+template<typename T>
+struct ilist_node {
+  [[nodiscard]] observer_ptr<T> prev() const {
+    return make_observer(m_prev);
+  }
+  [[nodiscard]] observer_ptr<T> next() const {
+    return make_observer(m_next);
+  }
+private:
+  friend struct ilist<T>;
+  T *m_prev{};
+  T *m_next{};
+};
+
+/**
+ * @brief an intrusive doubly linked list that owns arena-placed objects
+ * the links live in the elements themselves, so the position of an element is known from the element alone,
+ * and inserting, erasing or moving an element to another list is O(1) without any allocation
+ */
+template<typename T>
+struct ilist {
+  ilist() = default;
+  ilist(const ilist &) = delete;
+  ilist &operator=(const ilist &) = delete;
+  ~ilist() {
+    clear();
+  }
+
+  struct iterator {
+    iterator(T *node, const ilist *list) : node(node), list(list) {}
+    observer_ptr<T> operator*() const {
+      return make_observer(node);
+    }
+    observer_ptr<T> operator->() const {
+      return make_observer(node);
+    }
+    iterator &operator++() {
+      node = links(node).m_next;
+      return *this;
+    }
+    iterator &operator--() {
+      node = node ? links(node).m_prev : list->m_tail;
+      return *this;
+    }
+    bool operator==(const iterator &other) const {
+      return node == other.node;
+    }
+    bool operator!=(const iterator &other) const {
+      return node != other.node;
+    }
+  private:
+    friend struct ilist;
+    T *node;
+    const ilist *list;
+  };
+
+  iterator begin() const {
+    return iterator(m_head, this);
+  }
+  iterator end() const {
+    return iterator(nullptr, this);
+  }
+  // the element must be in this list
+  iterator iterator_to(T &element) const {
+    return iterator(&element, this);
+  }
+  [[nodiscard]] observer_ptr<T> front() const {
+    return make_observer(m_head);
+  }
+  [[nodiscard]] observer_ptr<T> back() const {
+    return make_observer(m_tail);
+  }
+  [[nodiscard]] size_t size() const {
+    return m_size;
+  }
+  [[nodiscard]] bool empty() const {
+    return m_size == 0;
+  }
+
+  // links the element in before pos and takes ownership of it
+  iterator insert(iterator pos, arena_ptr<T> element) {
+    auto node = element.release();
+    auto next = pos.node;
+    auto prev = next ? links(next).m_prev : m_tail;
+    links(node).m_prev = prev;
+    links(node).m_next = next;
+    (prev ? links(prev).m_next : m_head) = node;
+    (next ? links(next).m_prev : m_tail) = node;
+    m_size++;
+    return iterator(node, this);
+  }
+  void push_back(arena_ptr<T> element) {
+    insert(end(), std::move(element));
+  }
+  void push_front(arena_ptr<T> element) {
+    insert(begin(), std::move(element));
+  }
+  // unlinks the element and hands its ownership back, e.g. to insert it into another list
+  arena_ptr<T> remove(iterator pos) {
+    auto node = pos.node;
+    auto prev = links(node).m_prev;
+    auto next = links(node).m_next;
+    (prev ? links(prev).m_next : m_head) = next;
+    (next ? links(next).m_prev : m_tail) = prev;
+    links(node).m_prev = links(node).m_next = nullptr;
+    m_size--;
+    return arena_ptr<T>(node);
+  }
+  iterator erase(iterator pos) {
+    iterator next(links(pos.node).m_next, this);
+    remove(pos);
+    return next;
+  }
+  void clear() {
+    while (m_head)
+      erase(begin());
+  }
+private:
+  static ilist_node<T> &links(T *node) {
+    return *node;
+  }
+  T *m_head{};
+  T *m_tail{};
+  size_t m_size{};
+};
+
+}
+#endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MYSTL_ILIST_H
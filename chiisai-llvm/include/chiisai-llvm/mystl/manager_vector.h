@@ -53,13 +53,13 @@ struct manager_vector {
     data.erase(data.begin() + index);
   }
   struct iterator {
-    using container_iterator = typename std::vector<std::unique_ptr<T>>::iterator;
+    using container_iterator = typename std::vector<std::unique_ptr<T>>::const_iterator;
     explicit iterator(container_iterator it) : it(it) {}
     observer_ptr<T> operator*() {
-      return it->get();
+      return observer_ptr<T>(it->get());
     }
     observer_ptr<T> operator->() {
-      return it->get();
+      return observer_ptr<T>(it->get());
     }
     iterator &operator++() {
       ++it;
@@ -5,6 +5,7 @@
 #ifndef CACTRIE_CACT_PARSER_INCLUDE_CACT_PARSER_MYSTL_OBSERVER_PTR_H
 #define CACTRIE_CACT_PARSER_INCLUDE_CACT_PARSER_MYSTL_OBSERVER_PTR_H
 #include <cassert>
+#include <stdexcept>
 #include "hash.h"
 #include <functional>
 namespace llvm::mystl {
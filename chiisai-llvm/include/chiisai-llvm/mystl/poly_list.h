@@ -5,46 +5,38 @@
 #ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MYSTL_POLY_LIST_H
 #define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MYSTL_POLY_LIST_H
 #include "observer_ptr.h"
+#include "arena.h"
 #include <memory>
 #include <vector>
 #include <list>
 namespace llvm::mystl {
+/**
+ * @brief a list of polymorphic objects that, together with the nodes of the list, are placed in an arena
+ * the objects are destroyed with the list but their memory is only reclaimed when the arena is destroyed
+ */
 template<typename Base>
 struct poly_list {
 public:
-  template<typename Derived>
-  requires std::is_base_of_v<Base, Derived>
-  void emplace_back() {
-    container.emplace_back(std::make_unique<Derived>());
-  }
+  explicit poly_list(arena &storage) : storage(storage), container(arena_allocator<arena_ptr<Base>>(storage)) {}
   template<typename Derived, typename... Args>
   requires std::is_base_of_v<Base, Derived>
-  void emplace_back(Args &&... args) {
-    container.emplace_back(std::make_unique<Derived>(std::forward<Args>(args)...));
-  }
-  template<typename Derived>
-  void emplace_back(std::unique_ptr<Derived>&& ptr) {
+  observer_ptr<Derived> emplace_back(Args &&... args) {
+    auto ptr = storage.make<Derived>(std::forward<Args>(args)...);
+    auto observer = make_observer(ptr.get());
     container.emplace_back(std::move(ptr));
-  }
-  template<typename Derived>
-  void emplace_front() {
-    container.emplace_front(std::make_unique<Derived>());
+    return observer;
   }
   template<typename Derived, typename... Args>
-  void emplace_front(Args &&... args) {
-    container.emplace_front(std::make_unique<Derived>(std::forward<Args>(args)...));
-  }
-  template<typename Derived>
-  void push_back(std::unique_ptr<Derived> ptr) {
-    container.push_back(std::move(ptr));
-  }
-  template<typename Derived>
-  void push_front(std::unique_ptr<Derived> ptr) {
-    container.push_front(std::move(ptr));
+  requires std::is_base_of_v<Base, Derived>
+  observer_ptr<Derived> emplace_front(Args &&... args) {
+    auto ptr = storage.make<Derived>(std::forward<Args>(args)...);
+    auto observer = make_observer(ptr.get());
+    container.emplace_front(std::move(ptr));
+    return observer;
   }
 
   struct iterator {
-    using container_iterator = typename std::list<std::unique_ptr<Base>>::iterator;
+    using container_iterator = typename std::list<arena_ptr<Base>, arena_allocator<arena_ptr<Base>>>::const_iterator;
     explicit iterator(container_iterator it) : it(it) {}
     observer_ptr<Base> operator*() {
       return make_observer(it->get());
@@ -67,6 +59,7 @@ public:
       return it != other.it;
     }
   private:
+    friend struct poly_list;
     container_iterator it;
   };
   iterator begin() const {
@@ -78,61 +71,18 @@ public:
   iterator erase(iterator it) {
     return iterator(container.erase(it.it));
   }
-private:
-  std::list<std::unique_ptr<Base>> container{};
-};
-
-template <typename Base>
-struct poly_view_list {
-public:
-  template<typename Derived>
-  requires std::is_base_of_v<Base, Derived>
-  void push_back(observer_ptr<Derived> ptr) {
-    container.push_back(ptr);
+  [[nodiscard]] observer_ptr<Base> back() const {
+    return make_observer(container.back().get());
   }
-  template<typename Derived>
-  requires std::is_base_of_v<Base, Derived>
-  void push_front(observer_ptr<Derived> ptr) {
-    container.push_front(ptr);
+  [[nodiscard]] size_t size() const {
+    return container.size();
   }
-
-  struct iterator {
-    using container_iterator = typename std::vector<std::unique_ptr<Base>>::iterator;
-    explicit iterator(container_iterator it) : it(it) {}
-    observer_ptr<Base> operator*() {
-      return make_observer(it->get());
-    }
-    observer_ptr<Base> operator->() {
-      return it->get();
-    }
-    iterator &operator++() {
-      ++it;
-      return *this;
-    }
-    iterator &operator--() {
-      --it;
-      return *this;
-    }
-    bool operator==(const iterator &other) const {
-      return it == other.it;
-    }
-    bool operator!=(const iterator &other) const {
-      return it != other.it;
-    }
-  private:
-    container_iterator it;
-  };
-  iterator begin() const {
-    return iterator(container.begin());
-  }
-  iterator end() const {
-    return iterator(container.end());
-  }
-  iterator erase(iterator it) {
-    return iterator(container.erase(it.it));
+  [[nodiscard]] bool empty() const {
+    return container.empty();
   }
 private:
-  std::list<observer_ptr<Base>> container{};
+  arena &storage;
+  std::list<arena_ptr<Base>, arena_allocator<arena_ptr<Base>>> container;
 };
 }
 #endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MYSTL_POLY_LIST_H
@@ -0,0 +1,81 @@
+//
+// Created by creeper on 10/18/26.
+//
+
+#ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MYSTL_SHARDED_INTERNER_H
+#define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MYSTL_SHARDED_INTERNER_H
+#include <array>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <shared_mutex>
+#include <unordered_map>
+namespace llvm::mystl {
+
+/**
+ * @brief a table that keeps exactly one object per key and can be shared by many threads
+ * the keys are spread over independent shards by their hash, each guarded by its own reader-writer lock,
+ * so lookups of existing objects only take a shared lock, and threads inserting different keys rarely meet
+ * objects never move once created, so references to them stay valid for the lifetime of the table
+ */
+template<typename Key, typename T, typename Hash = std::hash<Key>, size_t ShardBits = 4>
+struct sharded_interner {
+  static constexpr size_t shard_count = size_t{1} << ShardBits;
+
+  sharded_interner() = default;
+  sharded_interner(const sharded_interner &) = delete;
+  sharded_interner &operator=(const sharded_interner &) = delete;
+
+  // the object of the key, calling make() for a std::unique_ptr<T> if there is none yet
+  // make() runs at most once per key, with the shard locked exclusively
+  template<typename Make>
+  T &intern(const Key &key, Make &&make) {
+    auto hashCode = Hash{}(key);
+    auto &shard = m_shards[shard_of(hashCode)];
+    {
+      std::shared_lock lock(shard.mutex);
+      if (auto it = shard.objects.find(key); it != shard.objects.end())
+        return *it->second;
+    }
+    std::unique_lock lock(shard.mutex);
+    if (auto it = shard.objects.find(key); it != shard.objects.end())
+      return *it->second;
+    auto &object = shard.storage.emplace_back(std::forward<Make>(make)());
+    shard.objects.emplace(key, object.get());
+    return *object;
+  }
+
+  // null if the key has not been interned
+  const T *find(const Key &key) const {
+    auto &shard = m_shards[shard_of(Hash{}(key))];
+    std::shared_lock lock(shard.mutex);
+    auto it = shard.objects.find(key);
+    return it == shard.objects.end() ? nullptr : it->second;
+  }
+
+  [[nodiscard]] size_t size() const {
+    size_t count{};
+    for (auto &shard : m_shards) {
+      std::shared_lock lock(shard.mutex);
+      count += shard.storage.size();
+    }
+    return count;
+  }
+private:
+  // the top bits of a multiplicative mix, since the low bits are what the maps inside the shards use
+  static size_t shard_of(size_t hashCode) {
+    return static_cast<size_t>((static_cast<uint64_t>(hashCode) * 0x9e3779b97f4a7c15ull) >> (64 - ShardBits));
+  }
+  // a cache line each, so that threads working on different shards do not contend for their locks
+  struct alignas(64) shard_type {
+    mutable std::shared_mutex mutex{};
+    std::unordered_map<Key, T *, Hash> objects{};
+    std::vector<std::unique_ptr<T>> storage{};
+  };
+  std::array<shard_type, shard_count> m_shards{};
+};
+
+}
+#endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MYSTL_SHARDED_INTERNER_H
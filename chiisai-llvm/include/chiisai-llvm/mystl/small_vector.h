@@ -0,0 +1,199 @@
+//
+// Created by creeper on 10/18/26.
+//
+
+#ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MYSTL_SMALL_VECTOR_H
+#define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MYSTL_SMALL_VECTOR_H
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <utility>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include <initializer_list>
+namespace llvm::mystl {
+
+/**
+ * @brief a vector whose first N elements are stored inline, so a small vector costs no allocation at all
+ * it only goes to the heap once it outgrows N, after which it behaves like a std::vector
+ * like for a std::vector, growing may move the elements, so pointers to them are stable only while it does not grow
+ * the size and the capacity are 32-bit to keep the header small, growing beyond that throws std::length_error
+ */
+template<typename T, size_t N>
+struct small_vector {
+  static_assert(N > 0, "a small_vector without inline capacity is a std::vector");
+  using value_type = T;
+  using iterator = T *;
+  using const_iterator = const T *;
+
+  small_vector() = default;
+  small_vector(std::initializer_list<T> elements) {
+    append(elements);
+  }
+  template<std::ranges::input_range Range> requires (!std::same_as<std::remove_cvref_t<Range>, small_vector>)
+  explicit small_vector(Range &&elements) {
+    append(std::forward<Range>(elements));
+  }
+  small_vector(const small_vector &other) {
+    append(other);
+  }
+  small_vector(small_vector &&other) noexcept {
+    take(std::move(other));
+  }
+  small_vector &operator=(const small_vector &other) {
+    if (this != &other) {
+      clear();
+      append(other);
+    }
+    return *this;
+  }
+  small_vector &operator=(small_vector &&other) noexcept {
+    if (this != &other) {
+      release();
+      take(std::move(other));
+    }
+    return *this;
+  }
+  ~small_vector() {
+    release();
+  }
+
+  template<typename... Args>
+  T &emplace_back(Args &&... args) {
+    // doubles up to the largest capacity, and throws once that is full
+    if (m_size == m_capacity)
+      grow(m_capacity == max_capacity ? max_capacity + 1 : std::min(size_t{m_capacity} * 2, max_capacity));
+    auto element = std::construct_at(m_data + m_size, std::forward<Args>(args)...);
+    m_size++;
+    return *element;
+  }
+  void push_back(const T &element) {
+    emplace_back(element);
+  }
+  void push_back(T &&element) {
+    emplace_back(std::move(element));
+  }
+  template<std::ranges::input_range Range>
+  void append(Range &&elements) {
+    if constexpr (std::ranges::sized_range<Range>)
+      reserve(m_size + std::ranges::size(elements));
+    for (auto &&element : elements)
+      emplace_back(std::forward<decltype(element)>(element));
+  }
+  void pop_back() {
+    std::destroy_at(m_data + --m_size);
+  }
+  // shifts the elements after pos down, so the order of the others is kept
+  iterator erase(const_iterator pos) {
+    auto first = m_data + (pos - m_data);
+    std::move(first + 1, m_data + m_size, first);
+    pop_back();
+    return first;
+  }
+  void reserve(size_t capacity) {
+    if (capacity > m_capacity)
+      grow(capacity);
+  }
+  void clear() {
+    std::destroy_n(m_data, m_size);
+    m_size = 0;
+  }
+
+  [[nodiscard]] size_t size() const {
+    return m_size;
+  }
+  [[nodiscard]] bool empty() const {
+    return m_size == 0;
+  }
+  [[nodiscard]] size_t capacity() const {
+    return m_capacity;
+  }
+  // whether the elements are still in the inline storage
+  [[nodiscard]] bool is_inline() const {
+    return m_data == inline_data();
+  }
+  T *data() {
+    return m_data;
+  }
+  const T *data() const {
+    return m_data;
+  }
+  T &operator[](size_t index) {
+    return m_data[index];
+  }
+  const T &operator[](size_t index) const {
+    return m_data[index];
+  }
+  T &front() {
+    return m_data[0];
+  }
+  const T &front() const {
+    return m_data[0];
+  }
+  T &back() {
+    return m_data[m_size - 1];
+  }
+  const T &back() const {
+    return m_data[m_size - 1];
+  }
+  iterator begin() {
+    return m_data;
+  }
+  iterator end() {
+    return m_data + m_size;
+  }
+  const_iterator begin() const {
+    return m_data;
+  }
+  const_iterator end() const {
+    return m_data + m_size;
+  }
+private:
+  T *inline_data() {
+    return reinterpret_cast<T *>(m_inline);
+  }
+  const T *inline_data() const {
+    return reinterpret_cast<const T *>(m_inline);
+  }
+  static constexpr size_t max_capacity = std::numeric_limits<uint32_t>::max();
+  void grow(size_t capacity) {
+    if (capacity > max_capacity)
+      throw std::length_error("small_vector cannot hold more than 2^32 - 1 elements");
+    capacity = std::max<size_t>(capacity, 1);
+    auto data = std::allocator<T>().allocate(capacity);
+    std::uninitialized_move_n(m_data, m_size, data);
+    std::destroy_n(m_data, m_size);
+    if (!is_inline())
+      std::allocator<T>().deallocate(m_data, m_capacity);
+    m_data = data;
+    m_capacity = static_cast<uint32_t>(capacity);
+  }
+  void release() {
+    clear();
+    if (!is_inline())
+      std::allocator<T>().deallocate(m_data, m_capacity);
+    m_data = inline_data();
+    m_capacity = N;
+  }
+  // expects this to be empty and inline
+  void take(small_vector &&other) {
+    if (other.is_inline()) {
+      std::uninitialized_move_n(other.m_data, other.m_size, m_data);
+      m_size = other.m_size;
+      other.clear();
+      return;
+    }
+    m_data = std::exchange(other.m_data, other.inline_data());
+    m_size = std::exchange(other.m_size, 0);
+    m_capacity = std::exchange(other.m_capacity, static_cast<uint32_t>(N));
+  }
+  T *m_data{inline_data()};
+  uint32_t m_size{};
+  uint32_t m_capacity{N};
+  alignas(T) std::byte m_inline[N * sizeof(T)];
+};
+
+}
+#endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_MYSTL_SMALL_VECTOR_H
@@ -0,0 +1,131 @@
+//
+// Created by creeper on 10/18/26.
+//
+
+#ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_NATIVE_FUNCTION_H
+#define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_NATIVE_FUNCTION_H
+#include <array>
+#include <optional>
+#include <concepts>
+#include <utility>
+#include <chiisai-llvm/result.h>
+#include <chiisai-llvm/integer-type.h>
+#include <chiisai-llvm/function-type.h>
+#include <chiisai-llvm/mystl/castings.h>
+namespace llvm {
+
+/**
+ * @brief maps a host C++ type to the IR type it can be exchanged with
+ * only the scalar types that a register can hold directly are supported
+ */
+template<typename T>
+struct NativeType;
+
+template<>
+struct NativeType<void> {
+  static bool matches(const Type &type) {
+    return type.type == Type::TypeEnum::Void;
+  }
+};
+
+template<>
+struct NativeType<bool> {
+  static bool matches(const Type &type) {
+    return type.isInteger() && mystl::cast<IntegerType>(type).bitWidth() == 1;
+  }
+};
+
+template<>
+struct NativeType<int32_t> {
+  static bool matches(const Type &type) {
+    return type.isInteger() && mystl::cast<IntegerType>(type).bitWidth() == 32;
+  }
+};
+
+template<>
+struct NativeType<int64_t> {
+  static bool matches(const Type &type) {
+    return type.isInteger() && mystl::cast<IntegerType>(type).bitWidth() == 64;
+  }
+};
+
+template<>
+struct NativeType<float> {
+  static bool matches(const Type &type) {
+    return type.type == Type::TypeEnum::Float;
+  }
+};
+
+template<>
+struct NativeType<double> {
+  static bool matches(const Type &type) {
+    return type.type == Type::TypeEnum::Double;
+  }
+};
+
+template<typename T>
+concept NativeScalar = requires(const Type &type) {
+  { NativeType<T>::matches(type) } -> std::same_as<bool>;
+};
+
+/**
+ * @brief a host function pointer bound to a declared-but-undefined IR function
+ * the signature is captured statically in the thunk, so a call unpacks the arguments
+ * straight from the caller's registers with std::get and never builds an argument vector
+ */
+struct NativeFunction {
+  static constexpr size_t MaxArity = 8;
+  using ErasedFn = void (*)();
+  using Args = std::array<const Result *, MaxArity>;
+  using Thunk = std::optional<Result> (*)(ErasedFn fn, const Args &args);
+  using SignatureChecker = bool (*)(const FunctionType &functionType);
+
+  template<typename Ret, typename... Params>
+  requires NativeScalar<Ret> && (NativeScalar<Params> && ...) && (!std::is_void_v<Params> && ...)
+  static NativeFunction bind(Ret (*fn)(Params...)) {
+    static_assert(sizeof...(Params) <= MaxArity, "too many arguments for a native function");
+    return NativeFunction{
+        .fn = reinterpret_cast<ErasedFn>(fn),
+        .thunk = &invoke<Ret, Params...>,
+        .matches = &signatureMatches<Ret, Params...>,
+        .arity = sizeof...(Params),
+    };
+  }
+
+  [[nodiscard]] std::optional<Result> call(const Args &args) const {
+    return thunk(fn, args);
+  }
+
+  template<typename Ret, typename... Params>
+  static bool signatureMatches(const FunctionType &functionType) {
+    if (functionType.argCount() != sizeof...(Params))
+      return false;
+    if (!NativeType<Ret>::matches(*functionType.returnValueType()))
+      return false;
+    size_t index = 0;
+    return (NativeType<Params>::matches(*functionType.argType(index++)) && ...);
+  }
+
+  ErasedFn fn{};
+  Thunk thunk{};
+  SignatureChecker matches{};
+  size_t arity{};
+private:
+  template<typename Ret, typename... Params>
+  static std::optional<Result> invoke(ErasedFn erased, const Args &args) {
+    return invokeImpl<Ret, Params...>(erased, args, std::index_sequence_for<Params...>{});
+  }
+
+  template<typename Ret, typename... Params, size_t... I>
+  static std::optional<Result> invokeImpl(ErasedFn erased, const Args &args, std::index_sequence<I...>) {
+    auto fn = reinterpret_cast<Ret (*)(Params...)>(erased);
+    if constexpr (std::is_void_v<Ret>) {
+      fn(std::get<Params>(args[I]->value)...);
+      return std::nullopt;
+    } else
+      return Result{fn(std::get<Params>(args[I]->value)...)};
+  }
+};
+
+}
+#endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_NATIVE_FUNCTION_H
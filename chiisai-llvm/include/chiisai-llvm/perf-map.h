@@ -0,0 +1,48 @@
+//
+// Created by creeper on 10/18/26.
+//
+
+#ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_PERF_MAP_H
+#define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_PERF_MAP_H
+#include <cstdio>
+#include <vector>
+#include <unordered_map>
+#include <chiisai-llvm/ref.h>
+#include <chiisai-llvm/properties.h>
+namespace llvm {
+
+struct Function;
+
+/**
+ * @brief makes interpreted functions visible to system profilers such as perf
+ * every interpreted function is entered through a tiny trampoline of machine code that is unique to the function,
+ * and the address range of each trampoline is written to /tmp/perf-<pid>.map under the name of the function,
+ * so a sampled call chain through the dispatch loop shows which Cact function it is running
+ * on hosts without trampolines, or where executable pages are refused, the function is called directly
+ */
+struct PerfMap : NonCopyable {
+  using Body = void (*)(void *context);
+
+  PerfMap();
+  PerfMap(PerfMap &&) = delete;
+  ~PerfMap();
+
+  // runs body(context) through the trampoline of the function, exceptions thrown by body propagate as usual
+  void run(const Function &function, Body body, void *context);
+  [[nodiscard]] static bool supported();
+private:
+  using Trampoline = void (*)(void *context, Body body);
+  Trampoline trampoline(const Function &function);
+  struct CodePage {
+    std::byte *base{};
+    size_t used{};
+  };
+  std::FILE *m_mapFile{};
+  std::vector<CodePage> m_codePages{};
+  // set once a page cannot be mapped or protected, after which no trampoline is made
+  bool m_unavailable{};
+  std::unordered_map<CRef<Function>, Trampoline> m_trampolines{};
+};
+
+}
+#endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_PERF_MAP_H
@@ -8,6 +8,9 @@
 namespace llvm {
 struct PointerType : Type {
   explicit PointerType(CRef<Type> elementType) : Type(TypeEnum::Pointer, {elementType}) {}
+  static bool classof(const Type *type) {
+    return type->type == TypeEnum::Pointer;
+  }
   [[nodiscard]] CRef<Type> elementType() const {
     return containedTypes[0];
   }
@@ -5,6 +5,7 @@
 #ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_PREDICATE_H
 #define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_PREDICATE_H
 #include <cstdint>
+#include <string_view>
 namespace llvm {
 enum class Predicate : uint8_t {
   EQ,
@@ -19,6 +20,7 @@ enum class Predicate : uint8_t {
   SLE,
 };
 
-Predicate stopdct(const std::string &str);
+// throws if the string does not name a predicate
+Predicate stopdct(std::string_view str);
 }
 #endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_PREDICATE_H
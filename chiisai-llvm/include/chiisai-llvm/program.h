@@ -0,0 +1,79 @@
+//
+// Created by creeper on 10/18/26.
+//
+
+#ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_PROGRAM_H
+#define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_PROGRAM_H
+#include <array>
+#include <memory>
+#include <chiisai-llvm/module.h>
+#include <chiisai-llvm/function.h>
+#include <chiisai-llvm/executor.h>
+#include <chiisai-llvm/llvm-context.h>
+#include <chiisai-llvm/properties.h>
+namespace llvm {
+
+struct CodeCache;
+
+/**
+ * @brief a module prepared once for repeated execution
+ * preparing parses and links the module, translates every function and allocates the data segment,
+ * after which any defined function can be invoked with typed arguments as many times as needed
+ * usage:
+ *   auto program = Program::parse("foo.ll");
+ *   program->bindNative("putint", &putint).prepare();
+ *   auto sum = program->invoke<int32_t>("add", 1, 2);
+ */
+struct Program : RAII {
+  // the parsers of textual IR, the one generated by ANTLR and the faster one of parseAssembly
+  enum class TextParser : uint8_t {
+    Fast,
+    Antlr,
+  };
+
+  Program(std::unique_ptr<LLVMContext> ctx, std::unique_ptr<Module> module);
+  /**
+   * @brief reads either textual IR or bitcode, see writeBitcode, whose function bodies are only decoded once called
+   * with a code cache, textual IR that was read before is loaded from the bitcode the cache kept of it
+   */
+  static std::unique_ptr<Program> parse(const std::string &path, TextParser textParser = TextParser::Antlr,
+                                        CodeCache *codeCache = nullptr);
+
+  // natives must be bound before the program is prepared, since linking checks that every callee is resolved
+  template<typename Ret, typename... Params>
+  Program &bindNative(const std::string &name, Ret (*fn)(Params...)) {
+    if (m_prepared)
+      throw std::runtime_error("cannot bind native function " + name + " after the program is prepared");
+    m_executor->bindNative(*m_module->function(name), fn);
+    return *this;
+  }
+
+  Program &prepare();
+
+  template<typename Ret, typename... Args>
+  requires NativeScalar<Ret> && (NativeScalar<Args> && ...) && (!std::is_void_v<Args> && ...)
+  Ret invoke(const std::string &name, Args... args) {
+    auto &function = exportedFunction(name);
+    if (!NativeFunction::signatureMatches<Ret, Args...>(functionType(function)))
+      throw std::runtime_error("invoking " + name + " with a signature that does not match its definition");
+    std::array<Result, sizeof...(Args)> argValues{Result{args}...};
+    auto ret = m_executor->call(function, argValues);
+    if constexpr (!std::is_void_v<Ret>)
+      return std::get<Ret>(ret->value);
+  }
+
+  [[nodiscard]] Module &module() { return *m_module; }
+  [[nodiscard]] Executor &executor() { return *m_executor; }
+private:
+  Function &exportedFunction(const std::string &name);
+  static const FunctionType &functionType(const Function &function);
+  void link();
+  std::unique_ptr<LLVMContext> m_ctx;
+  std::unique_ptr<Module> m_module;
+  std::unique_ptr<Executor> m_executor;
+  std::unordered_map<Symbol, Ref<Function>> m_exports{};
+  bool m_prepared{};
+};
+
+}
+#endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_PROGRAM_H
@@ -0,0 +1,60 @@
+//
+// Created by creeper on 11/3/24.
+//
+
+#ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_RESULT_H
+#define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_RESULT_H
+#include <variant>
+#include <cstdint>
+#include <stdexcept>
+#include <chiisai-llvm/address.h>
+namespace llvm {
+
+struct Result {
+  using Integer = std::variant<int32_t, int64_t>;
+  using Floating = std::variant<float, double>;
+
+  template<typename T>
+  requires std::is_same_v<T, bool> || std::is_same_v<T, int32_t> || std::is_same_v<T, int64_t>
+      || std::is_same_v<T, float> || std::is_same_v<T, double> || std::is_same_v<T, Address>
+  explicit Result(T value) : value(value) {}
+
+  explicit Result(Integer value) {
+    std::visit([this](auto v) { this->value = v; }, value);
+  }
+
+  explicit Result(Floating value) {
+    std::visit([this](auto v) { this->value = v; }, value);
+  }
+
+  std::variant<bool, int32_t, int64_t, float, double, Address> value;
+  [[nodiscard]] bool isBool() const {
+    return std::holds_alternative<bool>(value);
+  }
+  [[nodiscard]] bool isPointer() const {
+    return std::holds_alternative<Address>(value);
+  }
+  [[nodiscard]] bool canOperateWith(const Result &other) const {
+    return !isBool() && value.index() == other.value.index() && !std::holds_alternative<Address>(value);
+  }
+  [[nodiscard]] Integer toInteger() const {
+    if (std::holds_alternative<int32_t>(value))
+      return std::get<int32_t>(value);
+    if (std::holds_alternative<int64_t>(value))
+      return std::get<int64_t>(value);
+    throw std::runtime_error("Cannot convert to integer");
+  }
+  [[nodiscard]] Floating toFloating() const {
+    if (std::holds_alternative<float>(value))
+      return std::get<float>(value);
+    if (std::holds_alternative<double>(value))
+      return std::get<double>(value);
+    throw std::runtime_error("Cannot convert to floating point");
+  }
+  Address toPointer() const {
+    return std::get<Address>(value);
+  }
+};
+
+}
+#endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_RESULT_H
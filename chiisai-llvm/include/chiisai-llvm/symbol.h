@@ -0,0 +1,108 @@
+//
+// Created by creeper on 10/18/26.
+//
+
+#ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_SYMBOL_H
+#define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_SYMBOL_H
+#include <deque>
+#include <string>
+#include <cstdint>
+#include <optional>
+#include <functional>
+#include <string_view>
+#include <shared_mutex>
+#include <unordered_map>
+#include <chiisai-llvm/properties.h>
+#include <chiisai-llvm/mystl/flat_hash_map.h>
+namespace llvm {
+
+/**
+ * @brief an interned name, i.e. a pointer to the one copy of a string in a symbol table
+ * two symbols of a table are equal if and only if their names are, so names are compared and hashed as pointers
+ * a symbol refers into the table it was interned in, usually the one of a context, see LLVMContext::symbols,
+ * so it must not outlive that table, and symbols of different tables must not be compared
+ */
+struct Symbol {
+  Symbol() = default;
+
+  [[nodiscard]] const std::string &str() const {
+    return m_name ? m_name->name : EmptyName;
+  }
+  [[nodiscard]] bool empty() const {
+    return !m_name;
+  }
+  // the hash of the name, computed once when it was interned
+  [[nodiscard]] size_t nameHash() const {
+    return m_name ? m_name->hash : hashName({});
+  }
+  // the hash nameHash() is, for names that may not have been interned
+  static size_t hashName(std::string_view name) {
+    return std::hash<std::string_view>{}(name);
+  }
+  bool operator==(const Symbol &other) const = default;
+private:
+  friend struct SymbolTable;
+  friend struct std::hash<Symbol>;
+  struct Interned {
+    std::string name;
+    size_t hash;
+  };
+  static inline const std::string EmptyName{};
+  explicit Symbol(const Interned *name) : m_name(name) {}
+  // null for the empty name
+  const Interned *m_name{};
+};
+
+/**
+ * @brief owns the names interned in it, which are only freed together with the table
+ * it may be used from many threads at once, interning takes a lock but reading the name of a symbol does not
+ */
+struct SymbolTable : RAII {
+  Symbol intern(std::string_view name);
+  // the symbol of a name that has been interned, if any, looking up never interns
+  [[nodiscard]] std::optional<Symbol> find(std::string_view name) const;
+  [[nodiscard]] size_t size() const;
+private:
+  mutable std::shared_mutex m_mutex{};
+  // the keys view the stored names, which a deque never moves
+  std::unordered_map<std::string_view, const Symbol::Interned *> m_symbols{};
+  std::deque<Symbol::Interned> m_names{};
+};
+
+/**
+ * @brief hashes and compares symbols by their names, so that a table keyed by symbols can be probed with a name
+ * probing with a name skips the symbol table, with its lock, and works the same for names that were never interned
+ */
+struct SymbolNameHash {
+  using is_transparent = void;
+  size_t operator()(std::string_view name) const {
+    return Symbol::hashName(name);
+  }
+  size_t operator()(Symbol symbol) const {
+    return symbol.nameHash();
+  }
+};
+
+struct SymbolNameEqual {
+  using is_transparent = void;
+  bool operator()(Symbol lhs, Symbol rhs) const {
+    return lhs == rhs;
+  }
+  bool operator()(Symbol lhs, std::string_view rhs) const {
+    return lhs.str() == rhs;
+  }
+};
+
+// the table of the names of a scope, e.g. the functions of a module or the arguments of a function
+template<typename T>
+using SymbolMap = mystl::flat_hash_map<Symbol, T, SymbolNameHash, SymbolNameEqual>;
+
+}
+
+template<>
+struct std::hash<llvm::Symbol> {
+  size_t operator()(llvm::Symbol symbol) const {
+    return std::hash<const void *>{}(symbol.m_name);
+  }
+};
+#endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_SYMBOL_H
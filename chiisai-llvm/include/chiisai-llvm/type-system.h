@@ -4,7 +4,9 @@
 
 #ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_TYPE_SYSTEM_H
 #define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_TYPE_SYSTEM_H
-#include <unordered_map>
+#include <array>
+#include <atomic>
+#include <memory>
 #include <string_view>
 #include <chiisai-llvm/type.h>
 #include <chiisai-llvm/integer-type.h>
@@ -13,89 +15,68 @@
 #include <chiisai-llvm/pointer-type.h>
 #include <chiisai-llvm/ref.h>
 #include <chiisai-llvm/properties.h>
-#include <chiisai-llvm/mystl/manager_vector.h>
+#include <chiisai-llvm/mystl/small_vector.h>
+#include <chiisai-llvm/mystl/sharded_interner.h>
 namespace llvm {
 struct Type;
+/**
+ * @brief owns and interns every type of a context, and may be used from many threads at once
+ * derived types are keyed by the ids of their contained types and interned in sharded tables,
+ * and every type gets the next id, the basic types taking the first ones in a fixed order
+ */
 struct TypeSystem : RAII {
-  TypeSystem() : basicTypeMap({{"void", cref(voidInstance)},
-                               {"float", cref(floatInstance)},
-                               {"double", cref(doubleInstance)},
-                               {"bool", cref(boolInstance)},
-                               {"int", cref(intInstance)},
-                               {"long", cref(longInstance)}}) {}
+  explicit TypeSystem(LLVMContext &ctx);
+  ~TypeSystem();
 private:
   friend struct LLVMContext;
-  // String to Basic Type
-  CRef<Type> stobt(const std::string &str) {
-    return basicTypeMap[str];
+  // String to Basic Type, null if the string does not name one
+  [[nodiscard]] CRef<Type> stobt(std::string_view str) const;
+  CRef<ArrayType> arrayType(CRef<Type> elementType, size_t size);
+  CRef<PointerType> pointerType(CRef<Type> elementType);
+  CRef<FunctionType> functionType(std::span<const CRef<Type>> containedTypes);
+  // the type numbered id, which must have been handed out by this type system
+  [[nodiscard]] CRef<Type> type(uint32_t id) const;
+
+  // numbers the type and records it under its id, before the type is published to any other thread
+  template<typename T>
+  std::unique_ptr<T> registered(std::unique_ptr<T> type) {
+    enroll(*type);
+    return type;
   }
+  void enroll(Type &type);
 
-  CRef<ArrayType> arrayType(CRef<Type> elementType, size_t size) {
-    auto it = arrayTypeMap.find({elementType, size});
-    if (it != arrayTypeMap.end())
-      return it->second;
-    auto ref = createArrayType(elementType, size).arrayTypes.back();
-    arrayTypeMap.insert({{elementType, size}, ref});
-    return ref;
-  }
-
-  CRef<PointerType> pointerType(CRef<Type> elementType) {
-    auto it = pointerTypeMap.find(elementType);
-    if (it != pointerTypeMap.end())
-      return it->second;
-    auto ref = createPointerType(elementType).pointerTypes.back();
-    pointerTypeMap.insert({elementType, ref});
-    return ref;
-  }
-
-  CRef<FunctionType> functionType(const std::vector<CRef<Type>> &containedTypes) {
-    auto it = functionTypeMap.find(containedTypes);
-    if (it != functionTypeMap.end())
-      return it->second;
-    auto ref = createFunctionType(containedTypes[0], std::span(containedTypes).subspan(1)).functionTypes.back();
-    functionTypeMap.insert({containedTypes, ref});
-    return ref;
-  }
-
-
-
+  LLVMContext &m_ctx;
   Type voidInstance{Type::TypeEnum::Void}, floatInstance{Type::TypeEnum::Float},
       doubleInstance{Type::TypeEnum::Double};
 
   IntegerType boolInstance{1}, intInstance{32}, longInstance{64};
 
-  mystl::manager_vector<ArrayType> arrayTypes{};
-
-  mystl::manager_vector<PointerType> pointerTypes{};
-
-  mystl::manager_vector<FunctionType> functionTypes{};
-
-  std::unordered_map<std::string, CRef<Type>> basicTypeMap{};
-
-  using ArrayTypeKey = std::pair<CRef<Type>, size_t>;
-  std::unordered_map<ArrayTypeKey, CRef<ArrayType>> arrayTypeMap{};
-
-  using PointerTypeKey = CRef<Type>;
-  std::unordered_map<PointerTypeKey, CRef<PointerType>> pointerTypeMap{};
-
-  using FunctionTypeKey = std::vector<CRef<Type>>;
-  std::unordered_map<FunctionTypeKey, CRef<FunctionType>> functionTypeMap{};
-
-  TypeSystem &createArrayType(CRef<Type> elementType, size_t size) {
-    arrayTypes.emplace_back(elementType, size);
-    return *this;
-  }
-
-  TypeSystem &createPointerType(CRef<Type> elementType) {
-    pointerTypes.emplace_back(elementType);
-    return *this;
-  }
-
-  TypeSystem &createFunctionType(CRef<Type> returnType, std::span<const CRef<Type>> argTypes) {
-    functionTypes.emplace_back(returnType, argTypes);
-    return *this;
-  }
-
+  struct ArrayTypeKey {
+    uint32_t element;
+    uint64_t size;
+    bool operator==(const ArrayTypeKey &other) const = default;
+  };
+  struct ArrayTypeKeyHash {
+    size_t operator()(const ArrayTypeKey &key) const;
+  };
+  // the return type followed by the argument types
+  struct FunctionTypeKey {
+    mystl::small_vector<uint32_t, 6> contained;
+    bool operator==(const FunctionTypeKey &other) const;
+  };
+  struct FunctionTypeKeyHash {
+    size_t operator()(const FunctionTypeKey &key) const;
+  };
+  mystl::sharded_interner<ArrayTypeKey, ArrayType, ArrayTypeKeyHash> arrayTypes{};
+  mystl::sharded_interner<uint32_t, PointerType> pointerTypes{};
+  mystl::sharded_interner<FunctionTypeKey, FunctionType, FunctionTypeKeyHash> functionTypes{};
+
+  // the types by id, in chunks that never move, so that finding a type by id takes no lock
+  static constexpr size_t ChunkBits = 10;
+  static constexpr size_t ChunkSize = size_t{1} << ChunkBits;
+  static constexpr size_t MaxChunks = size_t{1} << 10;
+  std::array<std::atomic<const Type **>, MaxChunks> typeChunks{};
+  std::atomic<uint32_t> typeCount{};
 };
 }
 #endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_TYPE_SYSTEM_H
@@ -5,13 +5,20 @@
 #ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_TYPE_H
 #define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_TYPE_H
 #include <vector>
-#include <stdexcept>
+#include <cstdint>
 #include <chiisai-llvm/properties.h>
 #include <chiisai-llvm/ref.h>
 namespace llvm {
 
 struct IntegerType;
 struct LLVMContext;
+struct TypeSystem;
+/**
+ * @brief types are unique within a TypeSystem, so two types are equal exactly when they are the same object
+ * each type is also numbered with a compact id by the type system that owns it, which is as good as the type
+ * for keys and hashes within that context, but not across contexts or runs: the basic types come first,
+ * and the others are numbered in the order they are first made, which differs once several threads make them
+ */
 struct Type : RAII {
   enum class TypeEnum {
     Void,
@@ -47,30 +54,36 @@ struct Type : RAII {
     return type == TypeEnum::Float || type == TypeEnum::Double;
   }
 
+  // an array or a pointer always has exactly one contained type, which their constructors ensure
   [[nodiscard]] bool isArray() const {
-    if (type == TypeEnum::Array) {
-      [[likely]] if (containedTypes.size() == 1)
-        return true;
-      throw std::runtime_error("Array type must have exactly one contained type");
-    }
-    return false;
+    return type == TypeEnum::Array;
   }
 
   [[nodiscard]] bool isPointer() const {
-    if (type == TypeEnum::Pointer) {
-      [[likely]] if (containedTypes.size() == 1)
-        return true;
-      throw std::runtime_error("Pointer type must have exactly one contained type");
-    }
-    return false;
+    return type == TypeEnum::Pointer;
   }
 
   [[nodiscard]] bool isFunction() const {
     return type == TypeEnum::Function;
   }
 
+  [[nodiscard]] uint32_t id() const {
+    return m_id;
+  }
+  // the context whose type system owns the type, the names of the values of the type are interned in it
+  [[nodiscard]] LLVMContext &context() const {
+    return *m_context;
+  }
+  [[nodiscard]] bool hasContext() const {
+    return m_context != nullptr;
+  }
+
   TypeEnum type{TypeEnum::Void};
   std::vector<CRef<Type>> containedTypes{};
+private:
+  friend struct TypeSystem;
+  LLVMContext *m_context{};
+  uint32_t m_id{};
 };
 }
 #endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_TYPE_H
@@ -0,0 +1,100 @@
+//
+// Created by creeper on 10/18/26.
+//
+
+#ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_USE_H
+#define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_USE_H
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+#include <chiisai-llvm/ref.h>
+namespace llvm {
+
+struct Value;
+struct User;
+
+/**
+ * @brief one operand of a user, i.e. an edge of the use-def graph
+ * a use is linked both into the use list of its value and into the operand list of its user,
+ * so the uses of a value are found without any lookup, and rebinding a use is O(1)
+ * the slot is the field of the user that holds the operand, which set() rewrites along with the links
+ */
+struct Use {
+  Use(const Use &) = delete;
+  Use &operator=(const Use &) = delete;
+
+  // null once the value is destroyed, which detaches the use
+  [[nodiscard]] Ref<Value> value() const {
+    return isLinked() ? *m_slot : nullptr;
+  }
+  [[nodiscard]] Ref<User> user() const {
+    return mystl::make_observer(m_user);
+  }
+  // binds the operand to another value, moving the use to the use list of that value
+  void set(Ref<Value> value);
+
+  static Use &self(Use &use) {
+    return use;
+  }
+  static Ref<Value> valueOf(Use &use) {
+    return use.value();
+  }
+  static Ref<User> userOf(Use &use) {
+    return use.user();
+  }
+private:
+  friend struct Value;
+  friend struct User;
+  Use(User &user, Ref<Value> &slot) : m_user(&user), m_slot(&slot) {}
+  void link(Value *value);
+  void unlink();
+  [[nodiscard]] bool isLinked() const {
+    return m_prevUse != nullptr;
+  }
+
+  User *m_user;
+  // the value is read through the slot rather than kept in the use as well, which saves a word per operand
+  Ref<Value> *m_slot;
+  // the next field of the previous use, or the head of the use list, so that unlinking needs no value
+  Use **m_prevUse{};
+  Use *m_nextUse{};
+  Use *m_nextOperand{};
+};
+
+/**
+ * @brief a forward range over a chain of uses, following Next and yielding Project of each use
+ */
+template<Use *Use::*Next, auto Project>
+struct UseRange {
+  struct iterator {
+    using difference_type = std::ptrdiff_t;
+    using value_type = std::remove_cvref_t<decltype(Project(std::declval<Use &>()))>;
+    decltype(auto) operator*() const {
+      return Project(*use);
+    }
+    iterator &operator++() {
+      use = use->*Next;
+      return *this;
+    }
+    iterator operator++(int) {
+      auto old = *this;
+      ++*this;
+      return old;
+    }
+    bool operator==(const iterator &other) const = default;
+    Use *use;
+  };
+  [[nodiscard]] iterator begin() const {
+    return {head};
+  }
+  [[nodiscard]] iterator end() const {
+    return {nullptr};
+  }
+  [[nodiscard]] bool empty() const {
+    return head == nullptr;
+  }
+  Use *head;
+};
+
+}
+#endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_USE_H
@@ -5,19 +5,38 @@
 #ifndef CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_USER_H
 #define CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_USER_H
 #include <chiisai-llvm/value.h>
+#include <chiisai-llvm/mystl/arena.h>
 namespace llvm {
 
 struct User : Value {
-  explicit User(const std::string &name, CRef<Type> type) : Value(name, type) {}
+  explicit User(Kind kind, const std::string &name, CRef<Type> type) : Value(kind, name, type) {}
+  static bool classof(const Value *value) {
+    return value->kind() >= Kind::ConstantScalar;
+  }
+  // the uses of this user, in operand order
+  [[nodiscard]] UseRange<&Use::m_nextOperand, &Use::self> operands() const {
+    return {m_operandHead};
+  }
+  [[nodiscard]] UseRange<&Use::m_nextOperand, &Use::valueOf> usedValues() const {
+    return {m_operandHead};
+  }
+  ~User() override;
 private:
   friend struct Module;
 
-  friend void addUse(Ref<User> user, Ref<Value> value);
-  mystl::poly_view_list<Value> m_usedValues{};
+  friend void addUse(Ref<User> user, Ref<Value> &slot, mystl::arena &storage);
+  Use &appendOperand(Ref<Value> &slot, mystl::arena &storage);
+  Use *m_operandHead{};
+  Use *m_operandTail{};
 };
 
-void addUse(Ref<User> user, Ref<Value> value);
-
+/**
+ * @brief records that slot, a field of user, holds an operand, so that replacing the value rewrites the field
+ * the use is placed in storage, which must outlive the user, e.g. the arena of the function of an instruction
+ * the slot must stay where it is, so a container of operands must not grow once their uses are added,
+ * which is why instructions fill theirs in the constructor and only hand them out read only
+ */
+void addUse(Ref<User> user, Ref<Value> &slot, mystl::arena &storage);
 
 }
 #endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_USER_H
@@ -7,34 +7,75 @@
 #include <string>
 #include <format>
 #include <chiisai-llvm/type.h>
-#include <chiisai-llvm/mystl/poly_list.h>
+#include <chiisai-llvm/symbol.h>
+#include <chiisai-llvm/use.h>
 #include <minilog/logger.h>
 namespace llvm {
 
 struct User;
 struct Executor;
 struct Value : RAII, Executable {
-  explicit Value(const std::string& name, CRef<Type> type) : m_name(name), m_type(type) {}
+  // the most derived class of a value, which mystl::isa and the classof of each class test against
+  enum class Kind : uint8_t {
+    Argument,
+    Function,
+    GlobalVariable,
+    // users come last, constants first among them
+    ConstantScalar,
+    ConstantArray,
+    Instruction,
+  };
+  explicit Value(Kind kind, Symbol name, CRef<Type> type) : m_type(type), m_name(name), m_kind(kind) {}
+  // the name is interned in the context of the type, see Type::context
+  explicit Value(Kind kind, const std::string& name, CRef<Type> type);
+  [[nodiscard]] Kind kind() const {
+    return m_kind;
+  }
   [[nodiscard]] auto type() const {
     return m_type;
   }
   [[nodiscard]] const std::string& name() const {
+    return m_name.str();
+  }
+  [[nodiscard]] Symbol symbol() const {
     return m_name;
   }
-  auto& users() {
-    return m_users;
+  // every use of this value, in no particular order
+  [[nodiscard]] UseRange<&Use::m_nextUse, &Use::self> uses() const {
+    return {m_useHead};
+  }
+  // the user of each use, so a user with several operands bound to this value appears once per operand
+  [[nodiscard]] UseRange<&Use::m_nextUse, &Use::userOf> users() const {
+    return {m_useHead};
+  }
+  [[nodiscard]] bool hasUses() const {
+    return m_useHead != nullptr;
+  }
+  static constexpr uint32_t NoLocalIndex = UINT32_MAX;
+  // dense index of an argument or an instruction within its function, see Function::valueIndexBound
+  [[nodiscard]] uint32_t localIndex() const {
+    return m_localIndex;
+  }
+  [[nodiscard]] bool hasLocalIndex() const {
+    return m_localIndex != NoLocalIndex;
   }
+  // rebinds every use of this value to other, in time linear in the number of uses
   void replaceAllUsesWith(Ref<Value> other);
   void accept(Executor& executor) override {
     minilog::warn("value shouldn't be executed for class that inherits from Value");
   }
-  ~Value() override = default;
+  // uses that outlive the value are detached, so that their users can still be destroyed
+  ~Value() override;
 private:
+  friend struct Use;
   friend struct Module;
-  friend void addUse(Ref<User> user, Ref<Value> value);
-  mystl::poly_view_list<User> m_users{};
+  friend struct Function;
+  friend struct BasicBlock;
+  Use *m_useHead{};
   CRef<Type> m_type{};
-  std::string m_name{};
+  Symbol m_name{};
+  uint32_t m_localIndex{NoLocalIndex};
+  Kind m_kind;
 };
 }
 #endif //CACTRIE_CHIISAI_LLVM_INCLUDE_CHIISAI_LLVM_VALUE_H
@@ -0,0 +1,792 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <list>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <charconv>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <chiisai-llvm/asm-parser.h>
+#include <chiisai-llvm/module.h>
+#include <chiisai-llvm/function.h>
+#include <chiisai-llvm/predicate.h>
+#include <chiisai-llvm/instruction.h>
+#include <chiisai-llvm/mapped-file.h>
+#include <chiisai-llvm/llvm-context.h>
+#include <chiisai-llvm/mystl/castings.h>
+#include <chiisai-llvm/mystl/flat_hash_map.h>
+
+namespace llvm {
+
+namespace {
+
+struct Token {
+  enum Kind : uint8_t {
+    End,
+    // keywords, types, predicates and literals such as true are all words, told apart by where they are
+    Word,
+    // a word followed by a colon, which starts a basic block
+    Label,
+    // names keep their sigil, as the names of values do
+    Local,
+    Global,
+    Number,
+    Equals,
+    Comma,
+    LeftParen,
+    RightParen,
+    LeftBrace,
+    RightBrace,
+    LeftBracket,
+    RightBracket,
+    Asterisk,
+  };
+  Kind kind{End};
+  std::string_view text{};
+};
+
+bool isNameChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '.';
+}
+
+bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// reads the tokens of the text one at a time, each being a view of the text
+struct Lexer {
+  explicit Lexer(std::string_view text)
+      : m_begin(text.data()), m_cur(text.data()), m_end(text.data() + text.size()) {}
+
+  Token next() {
+    skipSpace();
+    if (m_cur == m_end)
+      return {Token::End, {m_end, 0}};
+    auto start = m_cur;
+    switch (*m_cur++) {
+    case '=': return {Token::Equals, view(start)};
+    case ',': return {Token::Comma, view(start)};
+    case '(': return {Token::LeftParen, view(start)};
+    case ')': return {Token::RightParen, view(start)};
+    case '{': return {Token::LeftBrace, view(start)};
+    case '}': return {Token::RightBrace, view(start)};
+    case '[': return {Token::LeftBracket, view(start)};
+    case ']': return {Token::RightBracket, view(start)};
+    case '*': return {Token::Asterisk, view(start)};
+    case '%':
+    case '@': {
+      while (m_cur != m_end && isNameChar(*m_cur))
+        m_cur++;
+      if (m_cur - start == 1)
+        error(start, std::string("expected a name after ") + *start);
+      return {*start == '%' ? Token::Local : Token::Global, view(start)};
+    }
+    default:
+      break;
+    }
+    auto first = *start;
+    if ((first >= '0' && first <= '9') || first == '-' || first == '+') {
+      // the spelling is checked by the constant pool, the lexer only finds where it ends, exponents included
+      while (m_cur != m_end && (isNameChar(*m_cur) || ((*m_cur == '-' || *m_cur == '+') && (m_cur[-1] == 'e' || m_cur[-1] == 'E'))))
+        m_cur++;
+      return {Token::Number, view(start)};
+    }
+    if (!isNameChar(first))
+      error(start, std::string("unexpected character ") + first);
+    while (m_cur != m_end && isNameChar(*m_cur))
+      m_cur++;
+    auto word = view(start);
+    auto after = m_cur;
+    while (after != m_end && isSpace(*after))
+      after++;
+    if (after != m_end && *after == ':') {
+      m_cur = after + 1;
+      return {Token::Label, word};
+    }
+    return {Token::Word, word};
+  }
+
+  // the offset of the first byte that is not lexed yet
+  [[nodiscard]] size_t position() const {
+    return static_cast<size_t>(m_cur - m_begin);
+  }
+  void seek(size_t position) {
+    m_cur = m_begin + position;
+  }
+  // moves past the brace closing the one just read, only looking at braces and comments on the way
+  void skipBody() {
+    auto start = m_cur;
+    size_t depth = 1;
+    while (m_cur != m_end) {
+      auto c = *m_cur++;
+      if (c == ';')
+        skipComment();
+      else if (c == '{')
+        depth++;
+      else if (c == '}' && --depth == 0)
+        return;
+    }
+    error(start, "the body of a function is not closed");
+  }
+
+  [[noreturn]] void error(const char *at, const std::string &message) const {
+    auto line = 1 + std::count(m_begin, at, '\n');
+    throw std::runtime_error("line " + std::to_string(line) + ": " + message);
+  }
+private:
+  std::string_view view(const char *start) const {
+    return {start, static_cast<size_t>(m_cur - start)};
+  }
+  void skipComment() {
+    auto newline = static_cast<const char *>(std::memchr(m_cur, '\n', static_cast<size_t>(m_end - m_cur)));
+    m_cur = newline ? newline : m_end;
+  }
+  void skipSpace() {
+    while (m_cur != m_end) {
+      if (isSpace(*m_cur))
+        m_cur++;
+      else if (*m_cur == ';')
+        skipComment();
+      else
+        return;
+    }
+  }
+
+  const char *m_begin;
+  const char *m_cur;
+  const char *m_end;
+};
+
+// the tokens, types and constants that the declarations and the bodies are both made of
+struct AsmReader {
+  AsmReader(std::string_view text, LLVMContext &ctx) : m_lexer(text), m_ctx(ctx) {}
+
+protected:
+  [[noreturn]] void error(const std::string &message) const {
+    m_lexer.error(m_token.text.data(), message);
+  }
+  // names are views of the text, so they tell where they were read
+  [[noreturn]] void error(std::string_view at, const std::string &message) const {
+    m_lexer.error(at.data(), message);
+  }
+  void advance() {
+    m_token = m_lexer.next();
+  }
+  std::string_view take() {
+    auto text = m_token.text;
+    advance();
+    return text;
+  }
+  bool accept(Token::Kind kind) {
+    if (m_token.kind != kind)
+      return false;
+    advance();
+    return true;
+  }
+  bool acceptWord(std::string_view word) {
+    if (m_token.kind != Token::Word || m_token.text != word)
+      return false;
+    advance();
+    return true;
+  }
+  std::string_view expect(Token::Kind kind, std::string_view what) {
+    if (m_token.kind != kind)
+      error("expected " + std::string(what));
+    return take();
+  }
+  void expectWord(std::string_view word) {
+    if (!acceptWord(word))
+      error("expected " + std::string(word));
+  }
+  uint32_t parseNumber(std::string_view what) {
+    return toNumber(expect(Token::Number, what), what);
+  }
+  uint32_t toNumber(std::string_view literal, std::string_view what) const {
+    uint32_t number{};
+    auto [end, errc] = std::from_chars(literal.data(), literal.data() + literal.size(), number);
+    if (errc != std::errc{} || end != literal.data() + literal.size())
+      error(literal, "malformed " + std::string(what) + " " + std::string(literal));
+    return number;
+  }
+
+  CRef<Type> basicType(std::string_view word) const {
+    if (word == "i32")
+      return m_ctx.intType();
+    if (word == "i1")
+      return m_ctx.boolType();
+    if (word == "i64")
+      return m_ctx.longType();
+    if (word == "f32")
+      return m_ctx.floatType();
+    if (word == "f64")
+      return m_ctx.doubleType();
+    if (word == "void")
+      return m_ctx.voidType();
+    return m_ctx.stobt(word);
+  }
+  bool atType() const {
+    return m_token.kind == Token::LeftBracket || (m_token.kind == Token::Word && basicType(m_token.text));
+  }
+  CRef<Type> parseType() {
+    CRef<Type> type{};
+    if (accept(Token::LeftBracket)) {
+      auto size = parseNumber("size of an array type");
+      expectWord("x");
+      auto elementType = parseType();
+      expect(Token::RightBracket, "]");
+      type = m_ctx.arrayType(elementType, size);
+    } else if (m_token.kind == Token::Word && (type = basicType(m_token.text)))
+      advance();
+    else
+      error("expected a type");
+    while (accept(Token::Asterisk))
+      type = m_ctx.pointerType(type);
+    return type;
+  }
+
+  Ref<Constant> constant(CRef<Type> type, std::string_view literal) {
+    if (!type || (!type->isInteger() && !type->isFloatingPoint()))
+      error(literal, "constant " + std::string(literal) + " is not of a scalar type");
+    try {
+      return m_ctx.constant(type, literal);
+    } catch (const std::runtime_error &e) {
+      error(literal, e.what());
+    }
+  }
+  // a scalar literal, or the elements of an array in either [T v, T v] or the [T N x T v, T v] of LLVMParser.g4
+  CRef<Constant> parseConstant(CRef<Type> type) {
+    if (!accept(Token::LeftBracket)) {
+      if (m_token.kind != Token::Number && m_token.kind != Token::Word)
+        error("expected a constant");
+      return constant(type, take());
+    }
+    auto arrayType = mystl::dyn_cast<ArrayType>(type);
+    std::vector<CRef<Constant>> elements{};
+    if (!accept(Token::RightBracket)) {
+      auto elementType = parseType();
+      if (m_token.kind != Token::Number)
+        elements.push_back(parseConstant(elementType));
+      else if (auto literal = take(); acceptWord("x")) {
+        arrayType = m_ctx.arrayType(elementType, toNumber(literal, "size of an array type"));
+        elements.push_back(parseTypedConstant());
+      } else
+        elements.push_back(constant(elementType, literal));
+      while (accept(Token::Comma))
+        elements.push_back(parseTypedConstant());
+      expect(Token::RightBracket, "]");
+    }
+    if (!arrayType)
+      error("an array constant of a type that is not an array");
+    try {
+      return m_ctx.constantArray(arrayType, elements);
+    } catch (const std::runtime_error &e) {
+      error(e.what());
+    }
+  }
+  CRef<Constant> parseTypedConstant() {
+    if (m_token.kind == Token::Local || m_token.kind == Token::Global)
+      error("the elements of a constant array must be constants");
+    auto type = parseType();
+    return parseConstant(type);
+  }
+
+  Lexer m_lexer;
+  LLVMContext &m_ctx;
+  Token m_token{};
+  // names are handed to the IR as strings, which this one buffer is reused for
+  std::string m_name{};
+};
+
+// stand-ins for the globals and constants used by one body, keyed by the values they stand in for, see BodyParser
+using SharedRefs = mystl::flat_hash_map<Value *, std::unique_ptr<Argument>>;
+
+/**
+ * builds the instructions of a body as they are read, with every global and function of the module known
+ * a local used before its definition, e.g. by a phi, is read through a stand-in that is replaced once it is defined,
+ * and a block used before it is labelled is created then and moved into place when its label is read
+ * globals and constants are shared by all the bodies, and so are their use lists, so a body built on a thread
+ * of its own reads them through stand-ins as well, which link binds to them once no thread is building any more
+ */
+struct BodyParser : AsmReader {
+  BodyParser(std::string_view text, LLVMContext &ctx, const Module &module) : AsmReader(text, ctx), m_module(module) {}
+
+  // the body starts at offset, with its brace, and reads the shared values through sharedRefs unless it is null
+  void parse(Function &function, size_t offset, SharedRefs *sharedRefs) {
+    m_sharedRefs = sharedRefs;
+    m_function = ref(function);
+    m_block = nullptr;
+    m_blocksMoved = false;
+    m_lexer.seek(offset);
+    advance();
+    while (!accept(Token::RightBrace)) {
+      if (m_token.kind == Token::Label)
+        labelBlock(take());
+      else if (!m_block)
+        error("an instruction before the first label of " + function.name());
+      else
+        parseInstruction();
+    }
+    // the keys are views of the first uses
+    for (const auto &[name, entry] : m_blocks)
+      if (!entry.labelled)
+        error(name, "use of undefined label %" + std::string(name) + " in " + function.name());
+    if (!m_forwardRefs.empty()) {
+      auto name = m_forwardRefs.begin()->first;
+      error(name, "cannot find symbol " + std::string(name));
+    }
+    // blocks were created out of order, so their indices are
+    if (m_blocksMoved)
+      function.renumber();
+    m_blocks.clear();
+  }
+
+  // binds the stand-ins of a body to the shared values, whose use lists must not be touched by another thread meanwhile
+  static void link(SharedRefs &sharedRefs) {
+    for (auto &[value, standIn] : sharedRefs)
+      standIn->replaceAllUsesWith(ref(*value));
+    sharedRefs.clear();
+  }
+
+private:
+  using BlockList = decltype(Function::basicBlocks);
+  struct BlockEntry {
+    Ref<BasicBlock> basicBlock{};
+    BlockList::iterator position{};
+    bool labelled{};
+  };
+
+  // a label names a new block, except one already used by a branch or a phi, which then moves to the end
+  void labelBlock(std::string_view name) {
+    auto &blocks = m_function->basicBlocks;
+    auto [it, inserted] = m_blocks.try_emplace(name);
+    auto &entry = it->second;
+    if (!inserted && entry.labelled)
+      error(name, "basic block " + std::string(name) + " is defined more than once");
+    if (!inserted) {
+      if (std::next(entry.position) != blocks.end())
+        blocks.splice(blocks.end(), blocks, entry.position);
+    } else
+      entry = newBlock(name);
+    entry.labelled = true;
+    m_block = entry.basicBlock;
+  }
+  BlockEntry newBlock(std::string_view name) {
+    // not through m_name, which may hold the name of the instruction whose operands are being read
+    auto &basicBlock = m_function->addBasicBlock(std::string(name));
+    return {ref(basicBlock), std::prev(m_function->basicBlocks.end())};
+  }
+  Ref<BasicBlock> parseLabel() {
+    auto name = expect(Token::Local, "a label").substr(1);
+    auto [it, inserted] = m_blocks.try_emplace(name);
+    if (inserted) {
+      it->second = newBlock(name);
+      m_blocksMoved = true;
+    }
+    return it->second.basicBlock;
+  }
+
+  Ref<Value> local(std::string_view name, CRef<Type> type) {
+    if (auto value = m_function->lookup(name))
+      return value;
+    if (auto it = m_forwardRefs.find(name); it != m_forwardRefs.end())
+      return ref<Value>(*it->second);
+    // without a type, the value cannot be stood in for
+    if (!type)
+      error("cannot find symbol " + std::string(name));
+    return ref<Value>(*m_forwardRefs.try_emplace(name, std::make_unique<Argument>("", type)).first->second);
+  }
+  // a global or a constant, read through a stand-in of the body if it is built on a thread of its own
+  Ref<Value> shared(Ref<Value> value) {
+    if (!m_sharedRefs)
+      return value;
+    auto &standIn = (*m_sharedRefs)[value.get()];
+    if (!standIn)
+      standIn = std::make_unique<Argument>("", value->type());
+    return ref<Value>(*standIn);
+  }
+  // a name or a literal of a known type
+  Ref<Value> parseOperand(CRef<Type> type) {
+    switch (m_token.kind) {
+    case Token::Local:
+      return local(take(), type);
+    case Token::Global: {
+      auto name = take();
+      if (!m_module.hasGlobalVar(name))
+        error("cannot find symbol " + std::string(name));
+      return shared(m_module.globalVariable(name));
+    }
+    case Token::Number:
+    case Token::Word:
+      return shared(constant(type, take()));
+    default:
+      error("expected a value");
+    }
+  }
+  // an operand that may be spelled after its type, as the values of LLVMParser.g4 and the typed operands of AsmWriter are
+  Ref<Value> parseValue(CRef<Type> type) {
+    if (atType())
+      type = parseType();
+    return parseOperand(type);
+  }
+  // a pointer is spelled with the type it points to, which is the type of the value, see AsmWriter
+  Ref<Value> parsePointer() {
+    auto type = mystl::dyn_cast<PointerType>(parseType());
+    if (!type)
+      error("expected a pointer type");
+    return parseOperand(type->elementType());
+  }
+  void skipAlignment() {
+    if (accept(Token::Comma)) {
+      expectWord("align");
+      parseNumber("alignment");
+    }
+  }
+
+  void parseInstruction() {
+    std::string_view name{};
+    if (m_token.kind == Token::Local) {
+      name = take();
+      expect(Token::Equals, "=");
+      if (m_function->lookup(name))
+        error("redefinition of " + std::string(name));
+    }
+    if (m_token.kind != Token::Word)
+      error("expected an instruction");
+    uint8_t op{};
+    try {
+      op = stoinst(m_token.text);
+    } catch (const std::runtime_error &e) {
+      error(e.what());
+    }
+    m_opName = m_token.text;
+    advance();
+    m_name.assign(name);
+    auto inst = parseInstruction(op);
+    // a local used before its definition is bound to it now
+    if (auto it = name.empty() ? m_forwardRefs.end() : m_forwardRefs.find(name); it != m_forwardRefs.end()) {
+      if (it->second->type() != inst->type())
+        error(std::string(name) + " is used with another type than it is defined with");
+      it->second->replaceAllUsesWith(inst);
+      m_forwardRefs.erase(name);
+    }
+  }
+
+  Ref<Instruction> parseInstruction(uint8_t op) {
+    auto &basicBlock = *m_block;
+    switch (op) {
+    case Instruction::Alloca: {
+      auto type = parseType();
+      uint32_t size = 1;
+      // 0 means no alignment required
+      uint32_t alignment = 0;
+      while (accept(Token::Comma)) {
+        if (acceptWord("align"))
+          alignment = parseNumber("alignment");
+        else
+          size = parseNumber("size of an alloca");
+      }
+      auto alloca = basicBlock.createInstruction<AllocaInst>(basicBlock, AllocaInstDetails{
+          .name = m_name, .type = type, .size = size, .alignment = alignment});
+      m_function->addLocalVar(alloca);
+      return alloca;
+    }
+    case Instruction::Load: {
+      auto type = parseType();
+      expect(Token::Comma, ",");
+      auto pointer = parsePointer();
+      skipAlignment();
+      return basicBlock.createInstruction<LoadInst>(basicBlock, MemInstDetails{
+          .name = m_name, .type = type, .pointer = pointer});
+    }
+    case Instruction::Store: {
+      auto type = parseType();
+      auto value = parseValue(type);
+      expect(Token::Comma, ",");
+      auto pointer = parsePointer();
+      skipAlignment();
+      return basicBlock.createInstruction<StoreInst>(basicBlock, StoreInstDetails{
+          .type = value->type(), .value = value, .pointer = pointer});
+    }
+    case Instruction::Gep: {
+      parseType();
+      expect(Token::Comma, ",");
+      auto pointer = parsePointer();
+      std::vector<Ref<Value>> indices{};
+      while (accept(Token::Comma))
+        indices.push_back(parseValue(m_ctx.intType()));
+      return basicBlock.createInstruction<GepInst>(basicBlock, GepInstDetails{
+          .name = m_name, .type = pointer->type(), .pointer = pointer, .indices = std::move(indices)});
+    }
+    case Instruction::Phi: {
+      auto type = parseType();
+      std::vector<PhiValue> incomingValues{};
+      do {
+        PhiValue incoming{};
+        if (accept(Token::LeftBracket)) {
+          incoming.value = parseValue(type);
+          expect(Token::Comma, ",");
+          incoming.basicBlock = parseLabel();
+          expect(Token::RightBracket, "]");
+        } else if (accept(Token::LeftBrace)) {
+          // { %block, value } of LLVMParser.g4
+          incoming.basicBlock = parseLabel();
+          expect(Token::Comma, ",");
+          incoming.value = parseValue(type);
+          expect(Token::RightBrace, "}");
+        } else
+          error("expected an incoming value of a phi");
+        incomingValues.push_back(incoming);
+      } while (accept(Token::Comma));
+      return basicBlock.createInstruction<PhiInst>(basicBlock, PhiInstDetails{
+          .name = m_name, .type = type, .incomingValues = std::move(incomingValues)});
+    }
+    case Instruction::Call: {
+      auto type = parseType();
+      auto calleeName = expect(Token::Global, "the name of a function").substr(1);
+      if (!m_module.hasFunction(calleeName))
+        error("call to undeclared function @" + std::string(calleeName));
+      auto &callee = *m_module.function(calleeName);
+      const auto &calleeType = mystl::cast<FunctionType>(*callee.type());
+      std::vector<Ref<Value>> realArgs{};
+      expect(Token::LeftParen, "(");
+      if (!accept(Token::RightParen)) {
+        do {
+          auto index = realArgs.size();
+          realArgs.push_back(parseValue(index < calleeType.argCount() ? calleeType.argType(index) : nullptr));
+        } while (accept(Token::Comma));
+        expect(Token::RightParen, ")");
+      }
+      if (realArgs.size() != calleeType.argCount())
+        error("call to @" + callee.name() + " with " + std::to_string(realArgs.size()) + " arguments, which takes "
+                  + std::to_string(calleeType.argCount()));
+      return basicBlock.createInstruction<CallInst>(basicBlock, CallInstDetails{
+          .name = m_name, .type = type, .function = callee, .realArgs = realArgs});
+    }
+    case Instruction::Ret: {
+      auto type = parseType();
+      Ref<Value> value{};
+      if (type != m_ctx.voidType())
+        value = parseValue(type);
+      return basicBlock.createInstruction<RetInst>(basicBlock, RetInstDetails{.ctx = m_ctx, .value = value});
+    }
+    case Instruction::Br: {
+      if (acceptWord("label"))
+        return basicBlock.createInstruction<BrInst>(basicBlock, m_ctx, parseLabel());
+      auto cond = parseValue(m_ctx.boolType());
+      expect(Token::Comma, ",");
+      expectWord("label");
+      auto thenBranch = parseLabel();
+      expect(Token::Comma, ",");
+      expectWord("label");
+      auto elseBranch = parseLabel();
+      return basicBlock.createInstruction<BrInst>(basicBlock, m_ctx, BrInst::Conditional{
+          .cond = cond, .thenBranch = thenBranch, .elseBranch = elseBranch});
+    }
+    case Instruction::ICmp:
+    case Instruction::FCmp: {
+      auto predicateName = expect(Token::Word, "a predicate");
+      Predicate predicate{};
+      try {
+        predicate = stopdct(predicateName);
+      } catch (const std::runtime_error &e) {
+        error(e.what());
+      }
+      auto type = parseType();
+      auto lhs = parseValue(type);
+      expect(Token::Comma, ",");
+      auto rhs = parseValue(type);
+      return basicBlock.createInstruction<CmpInst>(op, basicBlock, CmpInstDetails{
+          .ctx = m_ctx, .name = m_name, .lhs = lhs, .rhs = rhs, .predicate = predicate});
+    }
+    default: {
+      auto type = parseType();
+      auto lhs = parseValue(type);
+      expect(Token::Comma, ",");
+      auto rhs = parseValue(type);
+      if (!Instruction::checkBinaryInstType(lhs, rhs))
+        error("Binary instruction operands must have the same type");
+      op = stoinst(m_opName, *type);
+      return basicBlock.createInstruction<BinaryInst>(op, basicBlock, BinaryInstDetails{
+          .name = m_name, .type = lhs->type(), .lhs = lhs, .rhs = rhs});
+    }
+    }
+  }
+
+  const Module &m_module;
+  // the spelling of the instruction being parsed, which for some arithmetic takes the operand type to resolve
+  std::string_view m_opName{};
+  // stand-ins for locals used before their definition
+  mystl::flat_hash_map<std::string_view, std::unique_ptr<Argument>> m_forwardRefs{};
+  SharedRefs *m_sharedRefs{};
+  // the state of the body being parsed, keyed by views of the text
+  Ref<Function> m_function{};
+  Ref<BasicBlock> m_block{};
+  mystl::flat_hash_map<std::string_view, BlockEntry> m_blocks{};
+  bool m_blocksMoved{};
+};
+
+/**
+ * the declarations are built in a first pass, which skips over the bodies and remembers where they start,
+ * then the bodies are built with every global and function known, either one after another or,
+ * as they only meet at the declarations, on several threads, each body into the arena of its function
+ */
+struct AsmParser : AsmReader {
+  AsmParser(std::string_view text, LLVMContext &ctx)
+      : AsmReader(text, ctx), m_text(text), m_module(std::make_unique<Module>()) {}
+
+  std::unique_ptr<Module> parse(size_t threadCount) {
+    advance();
+    while (m_token.kind != Token::End)
+      parseTopLevel();
+    threadCount = std::min(threadCount, m_bodies.size());
+    if (threadCount > 1)
+      parseParallel(threadCount);
+    else {
+      auto &parser = m_bodyParsers.emplace_back(m_text, m_ctx, *m_module);
+      for (const auto &body : m_bodies)
+        parser.parse(*body.function, body.offset, nullptr);
+    }
+    return std::move(m_module);
+  }
+
+private:
+  struct Body {
+    Ref<Function> function;
+    size_t offset;
+  };
+
+  void parseTopLevel() {
+    if (m_token.kind == Token::Global) {
+      // @g = global T init, as printed by AsmWriter
+      auto name = take();
+      expect(Token::Equals, "=");
+      auto isConstant = acceptWord("constant");
+      if (!isConstant)
+        expectWord("global");
+      auto type = parseType();
+      auto initializer = acceptWord("zeroinitializer") ? nullptr : parseConstant(type);
+      addGlobal(name, type, initializer, isConstant);
+    } else if (acceptWord("global")) {
+      // global T @g, align init, as in LLVMParser.g4
+      auto type = parseType();
+      auto name = expect(Token::Global, "the name of a global variable");
+      CRef<Constant> initializer{};
+      if (accept(Token::Comma)) {
+        expectWord("align");
+        initializer = parseConstant(type);
+      }
+      addGlobal(name, type, initializer, false);
+    } else if (acceptWord("define"))
+      parseSignature(true);
+    else if (acceptWord("declare"))
+      parseSignature(false);
+    else
+      error("expected a global variable or a function");
+  }
+
+  void addGlobal(std::string_view name, CRef<Type> type, CRef<Constant> initializer, bool isConstant) {
+    if (m_module->hasGlobalVar(name) || m_module->hasFunction(name))
+      error(name, "Global variable name already exists in the module");
+    m_name.assign(name);
+    m_module->addGlobalVariable(std::make_unique<GlobalVariable>(GlobalVariableDetails{
+        .name = m_name,
+        .type = type,
+        .initializer = initializer,
+        .isConstant = isConstant,
+    }));
+  }
+
+  // the body of a definition is skipped, and parsed once all the declarations are known
+  void parseSignature(bool isDefinition) {
+    auto returnType = parseType();
+    // functions are named without their sigil
+    auto name = expect(Token::Global, "the name of a function").substr(1);
+    if (m_module->hasFunction(name))
+      error(name, "Function name already exists in the module");
+    if (m_module->hasGlobalVar(name))
+      error(name, "Global variable name already exists in the module");
+    std::vector<CRef<Type>> containedTypes{returnType};
+    std::vector<std::string> argNames{};
+    expect(Token::LeftParen, "(");
+    if (!accept(Token::RightParen)) {
+      do {
+        containedTypes.push_back(parseType());
+        argNames.emplace_back(m_token.kind == Token::Local ? take() : std::string_view{});
+      } while (accept(Token::Comma));
+      expect(Token::RightParen, ")");
+    }
+    m_module->addFunction(std::make_unique<Function>(FunctionInfo{
+        .name = std::string(name),
+        .functionType = m_ctx.functionType(containedTypes),
+        .argNames = std::move(argNames),
+        .module = *m_module,
+    }));
+    if (!isDefinition)
+      return;
+    if (m_token.kind != Token::LeftBrace)
+      error("expected {");
+    m_bodies.push_back({m_module->functions.back(), m_lexer.position()});
+    m_lexer.skipBody();
+    advance();
+  }
+
+  // the bodies are handed out in the order of the text, so when one fails, every body before it is still built,
+  // and the error thrown is the first in the text, as it is when they are built one after another
+  void parseParallel(size_t threadCount) {
+    auto count = m_bodies.size();
+    m_sharedRefs.resize(count);
+    std::vector<std::exception_ptr> errors(count);
+    std::atomic<size_t> next{};
+    std::atomic<bool> failed{};
+    m_bodyParsers.reserve(threadCount);
+    for (size_t t = 0; t < threadCount; t++)
+      m_bodyParsers.emplace_back(m_text, m_ctx, *m_module);
+    {
+      std::vector<std::jthread> threads{};
+      for (size_t t = 0; t < threadCount; t++)
+        threads.emplace_back([&, t] {
+          auto &parser = m_bodyParsers[t];
+          for (size_t i; !failed.load(std::memory_order_relaxed)
+                         && (i = next.fetch_add(1, std::memory_order_relaxed)) < count;) {
+            try {
+              parser.parse(*m_bodies[i].function, m_bodies[i].offset, &m_sharedRefs[i]);
+            } catch (...) {
+              errors[i] = std::current_exception();
+              failed.store(true, std::memory_order_relaxed);
+            }
+          }
+        });
+    }
+    for (const auto &error : errors)
+      if (error)
+        std::rethrow_exception(error);
+    // body by body in the order of the text, so the use lists of the shared values do not depend on the threads
+    for (auto &sharedRefs : m_sharedRefs)
+      BodyParser::link(sharedRefs);
+  }
+
+  std::string_view m_text;
+  // declared before the module, so that the stand-ins they hold outlive its uses of them
+  std::vector<BodyParser> m_bodyParsers{};
+  std::vector<SharedRefs> m_sharedRefs{};
+  std::unique_ptr<Module> m_module;
+  std::vector<Body> m_bodies{};
+};
+
+}
+
+std::unique_ptr<Module> parseAssembly(std::string_view text, LLVMContext &ctx, size_t threadCount) {
+  return AsmParser(text, ctx).parse(threadCount);
+}
+
+std::unique_ptr<Module> readAssembly(const std::filesystem::path &path, LLVMContext &ctx, size_t threadCount) {
+  MappedFile file(path);
+  return parseAssembly(file.text(), ctx, threadCount);
+}
+
+}
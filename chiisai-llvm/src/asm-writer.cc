@@ -0,0 +1,503 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <mutex>
+#include <atomic>
+#include <charconv>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <exception>
+#include <condition_variable>
+#include <unordered_map>
+#include <chiisai-llvm/asm-writer.h>
+#include <chiisai-llvm/module.h>
+#include <chiisai-llvm/function.h>
+#include <chiisai-llvm/instruction.h>
+#include <chiisai-llvm/constant-array.h>
+#include <chiisai-llvm/pointer-type.h>
+#include <chiisai-llvm/global-variable.h>
+#include <chiisai-llvm/mystl/castings.h>
+#if defined(__unix__)
+#include <unistd.h>
+#endif
+
+namespace llvm {
+
+namespace {
+
+std::string_view opName(uint8_t op) {
+  switch (op) {
+  case Instruction::Ret: return "ret";
+  case Instruction::Br: return "br";
+  case Instruction::Add: return "add";
+  case Instruction::Sub: return "sub";
+  case Instruction::Mul: return "mul";
+  case Instruction::SDiv: return "sdiv";
+  case Instruction::SRem: return "srem";
+  case Instruction::Xor: return "xor";
+  case Instruction::Shl: return "shl";
+  case Instruction::LShr: return "lshr";
+  case Instruction::AShr: return "ashr";
+  case Instruction::FAdd: return "fadd";
+  case Instruction::FSub: return "fsub";
+  case Instruction::FMul: return "fmul";
+  case Instruction::FDiv: return "fdiv";
+  case Instruction::And: return "and";
+  case Instruction::Or: return "or";
+  case Instruction::Alloca: return "alloca";
+  case Instruction::Load: return "load";
+  case Instruction::Store: return "store";
+  case Instruction::Gep: return "getelementptr";
+  case Instruction::Phi: return "phi";
+  case Instruction::Call: return "call";
+  case Instruction::ICmp: return "icmp";
+  case Instruction::FCmp: return "fcmp";
+  default: throw std::runtime_error("cannot print an instruction of unknown opcode");
+  }
+}
+
+std::string_view predicateName(Predicate predicate) {
+  switch (predicate) {
+  case Predicate::EQ: return "eq";
+  case Predicate::NE: return "ne";
+  case Predicate::UGT: return "ugt";
+  case Predicate::UGE: return "uge";
+  case Predicate::ULT: return "ult";
+  case Predicate::ULE: return "ule";
+  case Predicate::SGT: return "sgt";
+  case Predicate::SGE: return "sge";
+  case Predicate::SLT: return "slt";
+  case Predicate::SLE: return "sle";
+  }
+  throw std::runtime_error("cannot print a comparison of unknown predicate");
+}
+
+void appendNumber(std::string &out, uint64_t number) {
+  char digits[20];
+  auto end = std::to_chars(digits, digits + sizeof(digits), number).ptr;
+  out.append(digits, end);
+}
+
+void appendType(std::string &out, const Type &type) {
+  switch (type.type) {
+  case Type::TypeEnum::Void:
+    out += "void";
+    return;
+  case Type::TypeEnum::Float:
+    out += "f32";
+    return;
+  case Type::TypeEnum::Double:
+    out += "f64";
+    return;
+  case Type::TypeEnum::Integer:
+    out += 'i';
+    appendNumber(out, mystl::cast<IntegerType>(type).bitWidth());
+    return;
+  case Type::TypeEnum::Pointer:
+    appendType(out, *mystl::cast<PointerType>(type).elementType());
+    out += '*';
+    return;
+  case Type::TypeEnum::Array: {
+    const auto &arrayType = mystl::cast<ArrayType>(type);
+    out += '[';
+    appendNumber(out, arrayType.size);
+    out += " x ";
+    appendType(out, *arrayType.elementType());
+    out += ']';
+    return;
+  }
+  case Type::TypeEnum::Function: {
+    const auto &functionType = mystl::cast<FunctionType>(type);
+    appendType(out, *functionType.returnValueType());
+    out += " (";
+    for (size_t i = 0; i < functionType.argCount(); i++) {
+      if (i)
+        out += ", ";
+      appendType(out, *functionType.argType(i));
+    }
+    out += ')';
+    return;
+  }
+  }
+}
+
+// scalars print their canonical spelling, arrays their elements, each with its type
+void appendConstant(std::string &out, const Constant &constant) {
+  auto array = mystl::dyn_cast<ConstantArray>(&constant);
+  if (!array) {
+    out += constant.name();
+    return;
+  }
+  out += '[';
+  bool first = true;
+  for (auto element : array->elements()) {
+    if (!first)
+      out += ", ";
+    first = false;
+    appendType(out, *element->type());
+    out += ' ';
+    appendConstant(out, *element);
+  }
+  out += ']';
+}
+
+// whether the instruction defines a value, i.e. whether it is printed with a result
+bool definesValue(const Instruction &inst) {
+  if (inst.opCode == Instruction::Store || inst.isTerminator())
+    return false;
+  return inst.type()->type != Type::TypeEnum::Void;
+}
+
+/**
+ * prints one function, numbering the unnamed arguments and results in the order of their definitions
+ * names carry their sigil, % or @, except those of functions
+ */
+struct FunctionPrinter {
+  FunctionPrinter(std::string &out, const Function &function) : out(out) {
+    for (auto arg : function.args())
+      if (arg->name().empty())
+        slots.emplace(arg.get(), nextSlot++);
+    for (const auto &basicBlock : function.basicBlocks)
+      basicBlock.forEachInstruction([this](Ref<Instruction> inst) {
+        if (inst->name().empty() && definesValue(*inst))
+          slots.emplace(inst.get(), nextSlot++);
+      });
+  }
+
+  void print(const Function &function) {
+    out += function.isDeclaration() ? "declare " : "define ";
+    appendType(out, *mystl::cast<FunctionType>(*function.type()).returnValueType());
+    out += " @";
+    out += function.name();
+    out += '(';
+    bool first = true;
+    for (auto arg : function.args()) {
+      if (!first)
+        out += ", ";
+      first = false;
+      typedOperand(*arg);
+    }
+    out += ')';
+    if (function.isDeclaration()) {
+      out += '\n';
+      return;
+    }
+    out += " {\n";
+    for (const auto &basicBlock : function.basicBlocks) {
+      out += basicBlock.name();
+      out += ":\n";
+      basicBlock.forEachInstruction([this](Ref<Instruction> inst) {
+        out += "  ";
+        print(*inst);
+        out += '\n';
+      });
+    }
+    out += "}\n";
+  }
+
+private:
+  void operand(const Value &value) {
+    if (auto constant = mystl::dyn_cast<Constant>(&value))
+      return appendConstant(out, *constant);
+    if (auto function = mystl::dyn_cast<Function>(&value)) {
+      out += '@';
+      out += function->name();
+      return;
+    }
+    if (auto it = slots.find(&value); it != slots.end()) {
+      out += '%';
+      appendNumber(out, it->second);
+      return;
+    }
+    out += value.name();
+  }
+  void typedOperand(const Value &value) {
+    appendType(out, *value.type());
+    out += ' ';
+    operand(value);
+  }
+  // values used as pointers have the type of what they point to
+  void pointerOperand(const Value &pointer) {
+    appendType(out, *pointer.type());
+    out += "* ";
+    operand(pointer);
+  }
+  void label(const BasicBlock &basicBlock) {
+    out += "label %";
+    out += basicBlock.name();
+  }
+
+  void print(const Instruction &inst) {
+    if (definesValue(inst)) {
+      operand(inst);
+      out += " = ";
+    }
+    out += opName(inst.opCode);
+    out += ' ';
+    if (auto binary = mystl::dyn_cast<BinaryInst>(&inst)) {
+      typedOperand(*binary->lhs);
+      out += ", ";
+      operand(*binary->rhs);
+    } else if (auto cmp = mystl::dyn_cast<CmpInst>(&inst)) {
+      out += predicateName(cmp->predicate());
+      out += ' ';
+      typedOperand(*cmp->lhs);
+      out += ", ";
+      operand(*cmp->rhs);
+    } else if (auto alloca = mystl::dyn_cast<AllocaInst>(&inst)) {
+      appendType(out, *alloca->type());
+      if (alloca->size() != 1) {
+        out += ", ";
+        appendNumber(out, alloca->size());
+      }
+      if (alloca->alignment()) {
+        out += ", align ";
+        appendNumber(out, alloca->alignment());
+      }
+    } else if (auto load = mystl::dyn_cast<LoadInst>(&inst)) {
+      appendType(out, *load->type());
+      out += ", ";
+      pointerOperand(*load->pointer);
+    } else if (auto store = mystl::dyn_cast<StoreInst>(&inst)) {
+      typedOperand(*store->value);
+      out += ", ";
+      pointerOperand(*store->pointer);
+    } else if (auto gep = mystl::dyn_cast<GepInst>(&inst)) {
+      appendType(out, *gep->pointer->type());
+      out += ", ";
+      pointerOperand(*gep->pointer);
+      for (auto index : gep->indices()) {
+        out += ", ";
+        typedOperand(*index);
+      }
+    } else if (auto phi = mystl::dyn_cast<PhiInst>(&inst)) {
+      appendType(out, *phi->type());
+      bool first = true;
+      for (const auto &incoming : phi->incomingValues()) {
+        out += first ? " [ " : ", [ ";
+        first = false;
+        operand(*incoming.value);
+        out += ", %";
+        out += incoming.basicBlock->name();
+        out += " ]";
+      }
+    } else if (auto call = mystl::dyn_cast<CallInst>(&inst)) {
+      appendType(out, *call->type());
+      out += " @";
+      out += call->function.name();
+      out += '(';
+      bool first = true;
+      for (auto arg : call->realArgs()) {
+        if (!first)
+          out += ", ";
+        first = false;
+        typedOperand(*arg);
+      }
+      out += ')';
+    } else if (auto ret = mystl::dyn_cast<RetInst>(&inst)) {
+      if (ret->value)
+        typedOperand(*ret->value);
+      else
+        out += "void";
+    } else if (auto br = mystl::dyn_cast<BrInst>(&inst)) {
+      if (br->isConditional()) {
+        typedOperand(br->cond());
+        out += ", ";
+        label(br->thenBranch());
+        out += ", ";
+        label(br->elseBranch());
+      } else
+        label(br->thenBranch());
+    }
+  }
+
+  std::string &out;
+  std::unordered_map<const Value *, uint32_t> slots{};
+  uint32_t nextSlot{};
+};
+
+void formatGlobal(std::string &out, const GlobalVariable &global) {
+  out += global.name();
+  out += global.isConstant() ? " = constant " : " = global ";
+  appendType(out, *global.type());
+  out += ' ';
+  if (global.initializer())
+    appendConstant(out, *global.initializer());
+  else
+    out += "zeroinitializer";
+  out += '\n';
+}
+
+void formatFunction(std::string &out, const Function &function) {
+  FunctionPrinter(out, function).print(function);
+}
+
+}
+
+AsmWriter::AsmWriter(int fd, size_t bufferSize) : m_fd(fd), m_bufferSize(std::max<size_t>(bufferSize, 1)) {
+  m_buffer.reserve(m_bufferSize);
+}
+
+AsmWriter::~AsmWriter() {
+  try {
+    flush();
+  } catch (const std::exception &) {
+  }
+}
+
+AsmWriter &AsmWriter::print(Module &module) {
+  for (auto global : module.globalVariables)
+    print(*global);
+  for (auto function : module.functions) {
+    append("\n");
+    print(*function);
+  }
+  return *this;
+}
+
+AsmWriter &AsmWriter::print(Function &function) {
+  function.materialize();
+  formatFunction(m_buffer, function);
+  flushIfFull();
+  return *this;
+}
+
+AsmWriter &AsmWriter::print(const GlobalVariable &global) {
+  formatGlobal(m_buffer, global);
+  flushIfFull();
+  return *this;
+}
+
+AsmWriter &AsmWriter::printParallel(Module &module, size_t threadCount) {
+  auto count = module.functions.size();
+  threadCount = std::min(threadCount, count);
+  if (threadCount <= 1)
+    return print(module);
+  // materializers are not meant to be shared by threads, so every body is built before the threads start
+  module.materializeAll();
+  for (auto global : module.globalVariables)
+    print(*global);
+  // a function is only formatted when it is within a window of the next one to be written,
+  // so no more texts are held at a time than a few per thread
+  const size_t window = threadCount * 4;
+  std::mutex mutex{};
+  std::condition_variable changed{};
+  std::vector<std::string> texts(count);
+  std::vector<bool> finished(count);
+  size_t written{};
+  bool aborted{};
+  std::exception_ptr error{};
+  std::atomic<size_t> next{};
+  auto work = [&] {
+    for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < count;) {
+      {
+        std::unique_lock lock(mutex);
+        changed.wait(lock, [&] { return aborted || i < written + window; });
+        if (aborted)
+          return;
+      }
+      std::string text{};
+      std::exception_ptr failure{};
+      try {
+        formatFunction(text, *module.functions[i]);
+      } catch (...) {
+        failure = std::current_exception();
+      }
+      std::lock_guard lock(mutex);
+      texts[i] = std::move(text);
+      finished[i] = true;
+      if (failure && !error)
+        error = failure;
+      changed.notify_all();
+    }
+  };
+  {
+    std::vector<std::jthread> threads{};
+    for (size_t t = 0; t < threadCount; t++)
+      threads.emplace_back(work);
+    for (size_t i = 0; i < count; i++) {
+      std::string text{};
+      {
+        std::unique_lock lock(mutex);
+        changed.wait(lock, [&] { return finished[i] || error; });
+        if (error) {
+          aborted = true;
+          changed.notify_all();
+          break;
+        }
+        text = std::move(texts[i]);
+        written = i + 1;
+        changed.notify_all();
+      }
+      // a failed write has to release the workers waiting on the window before the threads are joined
+      try {
+        append("\n");
+        append(text);
+      } catch (...) {
+        std::lock_guard lock(mutex);
+        if (!error)
+          error = std::current_exception();
+        aborted = true;
+        changed.notify_all();
+        break;
+      }
+    }
+  }
+  if (error)
+    std::rethrow_exception(error);
+  return *this;
+}
+
+AsmWriter &AsmWriter::flush() {
+  writeOut(m_buffer);
+  // cleared rather than released, so the buffer is allocated once for the whole output
+  m_buffer.clear();
+  return *this;
+}
+
+std::string AsmWriter::str(Function &function) {
+  function.materialize();
+  std::string text{};
+  formatFunction(text, function);
+  return text;
+}
+
+std::string AsmWriter::str(const Type &type) {
+  std::string text{};
+  appendType(text, type);
+  return text;
+}
+
+void AsmWriter::append(std::string_view text) {
+  // text that would not fit goes straight to the descriptor rather than growing the buffer
+  if (m_buffer.size() + text.size() > m_bufferSize) {
+    flush();
+    if (text.size() >= m_bufferSize)
+      return writeOut(text);
+  }
+  m_buffer.append(text);
+}
+
+void AsmWriter::flushIfFull() {
+  if (m_buffer.size() >= m_bufferSize)
+    flush();
+}
+
+void AsmWriter::writeOut(std::string_view text) {
+  while (!text.empty()) {
+#if defined(__unix__)
+    auto written = ::write(m_fd, text.data(), text.size());
+    if (written < 0 && errno == EINTR)
+      continue;
+    if (written <= 0)
+      throw std::runtime_error(std::string("failed to write IR: ") + std::strerror(errno));
+    text.remove_prefix(static_cast<size_t>(written));
+#else
+    throw std::runtime_error("writing IR to a file descriptor is not supported on this platform");
+#endif
+  }
+}
+
+}
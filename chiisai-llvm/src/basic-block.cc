@@ -1,16 +1,100 @@
 //
 // Created by creeper on 10/13/24.
 //
+#include <algorithm>
 #include <chiisai-llvm/instruction.h>
 #include <chiisai-llvm/basic-block.h>
+#include <chiisai-llvm/function.h>
 #include <chiisai-llvm/executor.h>
 namespace llvm {
 
-BasicBlock &BasicBlock::addInstruction(std::unique_ptr<Instruction> &&instruction) {
-  m_localResultMap[instruction->name()] = mystl::make_observer(instruction.get());
-  instructions.emplace_back(std::move(instruction));
-  return *this;
+void BasicBlock::adopt(mystl::ilist<Instruction>::iterator pos, mystl::arena_ptr<Instruction> inst) {
+  auto &parent = function();
+  // the numbering stays canonical only while instructions are appended to the last block
+  if (inst->hasLocalIndex() || pos != instructions.end() || &parent.basicBlocks.back() != this)
+    parent.m_numberingCanonical = false;
+  if (!inst->hasLocalIndex())
+    inst->m_localIndex = parent.m_valueIndexBound++;
+  parent.m_revision++;
+  inst->m_basicBlock = ref(*this);
+  if (!inst->symbol().empty())
+    parent.m_localResults[inst->symbol()] = mystl::make_observer(inst.get());
+  addEdges(*inst);
+  instructions.insert(pos, std::move(inst));
 }
+
+mystl::arena_ptr<Instruction> BasicBlock::release(Instruction &inst) {
+  if (&inst.basicBlock() != this)
+    throw std::runtime_error("instruction " + inst.name() + " does not belong to basic block " + name());
+  // the name is only unbound if it is still bound to this instruction
+  if (auto it = function().m_localResults.find(inst.symbol());
+      it != function().m_localResults.end() && it->second.get() == &inst)
+    function().m_localResults.erase(inst.symbol());
+  function().m_numberingCanonical = false;
+  function().m_revision++;
+  removeEdges(inst);
+  return instructions.remove(instructions.iterator_to(inst));
+}
+
+namespace {
+
+using Edges = mystl::small_vector<Ref<BasicBlock>, 2>;
+
+// one entry for one edge, since parallel edges are listed once each
+Ref<BasicBlock> *findEdge(Edges &edges, BasicBlock &block) {
+  auto it = std::ranges::find(edges, ref(block));
+  if (it == edges.end())
+    throw std::runtime_error("no edge to basic block " + block.name());
+  return it;
+}
+
+// the predecessors have no order to keep, so the last one fills the hole
+void removePredecessor(Edges &predecessors, BasicBlock &block) {
+  *findEdge(predecessors, block) = predecessors.back();
+  predecessors.pop_back();
+}
+
+}
+
+void BasicBlock::addEdges(const Instruction &inst) {
+  if (auto br = mystl::dyn_cast<BrInst>(&inst))
+    for (size_t i = 0; i < br->successorCount(); i++)
+      addSuccessor(*br->successor(i));
+}
+
+void BasicBlock::removeEdges(const Instruction &inst) {
+  if (auto br = mystl::dyn_cast<BrInst>(&inst))
+    for (size_t i = 0; i < br->successorCount(); i++)
+      removeSuccessor(*br->successor(i));
+}
+
+void BasicBlock::addSuccessor(BasicBlock &dest) {
+  m_successors.push_back(ref(dest));
+  dest.m_predecessors.push_back(ref(*this));
+}
+
+void BasicBlock::removeSuccessor(BasicBlock &dest) {
+  m_successors.erase(findEdge(m_successors, dest));
+  removePredecessor(dest.m_predecessors, *this);
+}
+
+void BasicBlock::replaceSuccessor(size_t index, BasicBlock &to) {
+  if (index >= m_successors.size())
+    throw std::runtime_error("basic block " + name() + " has no successor " + std::to_string(index));
+  auto &edge = m_successors[index];
+  removePredecessor(edge->m_predecessors, *this);
+  edge = ref(to);
+  to.m_predecessors.push_back(ref(*this));
+}
+
+Ref<Value> BasicBlock::localResult(std::string_view name) const {
+  const auto &results = function().m_localResults;
+  auto it = results.find(name);
+  if (it == results.end() || &mystl::cast<Instruction>(*it->second).basicBlock() != this)
+    return nullptr;
+  return it->second;
+}
+
 void BasicBlock::accept(Executor &executor) {
   for (auto inst : instructions)
     executor.execute(inst);
@@ -0,0 +1,699 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <bit>
+#include <limits>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <chiisai-llvm/bitcode.h>
+#include <chiisai-llvm/module.h>
+#include <chiisai-llvm/function.h>
+#include <chiisai-llvm/instruction.h>
+#include <chiisai-llvm/llvm-context.h>
+#include <chiisai-llvm/mapped-file.h>
+#include <chiisai-llvm/global-variable.h>
+#include <chiisai-llvm/mystl/castings.h>
+
+namespace llvm {
+
+namespace {
+
+/**
+ * the sections are addressed by word offsets from the end of the header, and names by byte offsets into the
+ * name section, which follows the words
+ */
+struct BitcodeHeader {
+  static constexpr uint32_t Magic = 0x43424352;
+  static constexpr uint32_t Version = BitcodeVersion;
+  uint32_t magic{Magic};
+  uint32_t version{Version};
+  uint32_t functionCount{};
+  uint32_t functionIndex{};
+  uint32_t typeCount{};
+  uint32_t types{};
+  uint32_t constantCount{};
+  uint32_t constantIndex{};
+  uint32_t globalCount{};
+  uint32_t globals{};
+  uint32_t wordCount{};
+  uint32_t namesSize{};
+};
+
+// one entry of the function index, a declaration has an empty body
+struct FunctionEntry {
+  uint32_t nameOffset;
+  uint32_t nameSize;
+  uint32_t type;
+  uint32_t argNames;
+  uint32_t body;
+  uint32_t bodySize;
+};
+constexpr size_t FunctionEntryWords = sizeof(FunctionEntry) / sizeof(uint32_t);
+
+// an operand is the index of a value in its table, tagged with the table in the low bits
+enum ValueTag : uint32_t {
+  LocalValue,
+  ConstantValue,
+  GlobalValue,
+};
+constexpr uint32_t ValueTagBits = 2;
+constexpr uint32_t NoValue = std::numeric_limits<uint32_t>::max();
+
+enum ConstantTag : uint32_t {
+  ScalarConstant,
+  ArrayConstant,
+};
+
+uint32_t narrow(size_t value) {
+  if (value > std::numeric_limits<uint32_t>::max())
+    throw std::runtime_error("module is too large for bitcode");
+  return static_cast<uint32_t>(value);
+}
+
+/**
+ * types, constants and names are collected while the functions and globals are written, each into its own
+ * section, and the sections are laid out once everything has been written
+ */
+struct BitcodeWriter {
+  explicit BitcodeWriter(Module &module) : module(module) {}
+
+  void write(const std::filesystem::path &path) {
+    module.materializeAll();
+    for (auto function : module.functions)
+      functionIndices.emplace(function.get(), narrow(functionIndices.size()));
+    for (auto global : module.globalVariables)
+      globalIndices.emplace(global.get(), narrow(globalIndices.size()));
+    std::vector<FunctionEntry> entries{};
+    entries.reserve(module.functions.size());
+    for (auto function : module.functions)
+      entries.push_back(writeFunction(*function));
+    for (auto global : module.globalVariables)
+      writeGlobal(*global);
+
+    BitcodeHeader header{
+        .functionCount = narrow(entries.size()),
+        .functionIndex = 0,
+        .typeCount = narrow(typeIndices.size()),
+        .constantCount = narrow(constantOffsets.size()),
+        .globalCount = narrow(globalIndices.size()),
+        .namesSize = narrow(names.size()),
+    };
+    // the index comes first, then the bodies, whose offsets were taken relative to the end of the index
+    auto bodies = narrow(entries.size() * FunctionEntryWords);
+    header.types = bodies + narrow(bodyWords.size());
+    header.constantIndex = header.types + narrow(typeWords.size());
+    header.globals = header.constantIndex + narrow(constantOffsets.size() + constantWords.size());
+    header.wordCount = header.globals + narrow(globalWords.size());
+    auto constants = header.constantIndex + narrow(constantOffsets.size());
+    for (auto &entry : entries) {
+      entry.argNames += bodies;
+      entry.body += bodies;
+    }
+    for (auto &offset : constantOffsets)
+      offset += constants;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+      throw std::runtime_error("failed to open file " + path.string());
+    auto writeWords = [&file](const auto &words) {
+      file.write(reinterpret_cast<const char *>(words.data()),
+                 static_cast<std::streamsize>(words.size() * sizeof(words[0])));
+    };
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    writeWords(entries);
+    writeWords(bodyWords);
+    writeWords(typeWords);
+    writeWords(constantOffsets);
+    writeWords(constantWords);
+    writeWords(globalWords);
+    file.write(names.data(), static_cast<std::streamsize>(names.size()));
+    if (!file)
+      throw std::runtime_error("failed to write bitcode to " + path.string());
+  }
+
+private:
+  uint32_t nameOffset(std::string_view name) {
+    // names are views of interned symbols, which live as long as the program
+    auto [it, inserted] = nameOffsets.try_emplace(name, narrow(names.size()));
+    if (inserted)
+      names.append(name);
+    return it->second;
+  }
+  void writeName(std::vector<uint32_t> &words, std::string_view name) {
+    words.push_back(nameOffset(name));
+    words.push_back(narrow(name.size()));
+  }
+
+  uint32_t typeIndex(const Type &type) {
+    if (auto it = typeIndices.find(&type); it != typeIndices.end())
+      return it->second;
+    // contained types come first, so that the reader only ever refers back
+    std::vector<uint32_t> contained{};
+    for (auto containedType : type.containedTypes)
+      contained.push_back(typeIndex(*containedType));
+    typeWords.push_back(static_cast<uint32_t>(type.type));
+    if (type.isInteger())
+      typeWords.push_back(narrow(mystl::cast<IntegerType>(type).bitWidth()));
+    else if (type.isArray())
+      typeWords.insert(typeWords.end(), {contained[0], narrow(mystl::cast<ArrayType>(type).size)});
+    else if (type.isPointer())
+      typeWords.push_back(contained[0]);
+    else if (type.isFunction()) {
+      typeWords.push_back(narrow(contained.size()));
+      typeWords.insert(typeWords.end(), contained.begin(), contained.end());
+    }
+    return typeIndices.emplace(&type, narrow(typeIndices.size())).first->second;
+  }
+
+  uint32_t constantIndex(const Constant &constant) {
+    if (auto it = constantIndices.find(&constant); it != constantIndices.end())
+      return it->second;
+    std::vector<uint32_t> record{};
+    if (auto array = mystl::dyn_cast<ConstantArray>(&constant)) {
+      record.insert(record.end(), {ArrayConstant, typeIndex(*array->type()), narrow(array->elements().size())});
+      for (auto element : array->elements())
+        record.push_back(constantIndex(*element));
+    } else {
+      auto bits = mystl::cast<ConstantScalar>(constant).bits();
+      record.insert(record.end(), {ScalarConstant, typeIndex(*constant.type()),
+                                   static_cast<uint32_t>(bits), static_cast<uint32_t>(bits >> 32)});
+    }
+    constantOffsets.push_back(narrow(constantWords.size()));
+    constantWords.insert(constantWords.end(), record.begin(), record.end());
+    return constantIndices.emplace(&constant, narrow(constantIndices.size())).first->second;
+  }
+
+  void writeGlobal(const GlobalVariable &global) {
+    writeName(globalWords, global.name());
+    globalWords.push_back(typeIndex(*global.type()));
+    globalWords.push_back(global.initializer() ? constantIndex(*global.initializer()) : NoValue);
+    globalWords.push_back(global.isConstant());
+  }
+
+  FunctionEntry writeFunction(const Function &function) {
+    auto name = nameOffset(function.name());
+    auto type = typeIndex(*function.type());
+    auto argNames = narrow(bodyWords.size());
+    for (auto arg : function.args())
+      writeName(bodyWords, arg->name());
+    auto body = narrow(bodyWords.size());
+    if (!function.isDeclaration())
+      writeBody(function);
+    return FunctionEntry{
+        .nameOffset = name,
+        .nameSize = narrow(function.name().size()),
+        .type = type,
+        .argNames = argNames,
+        .body = body,
+        .bodySize = narrow(bodyWords.size()) - body,
+    };
+  }
+
+  /**
+   * a body is the number of blocks and of instructions, the name and size of every block, the type of every
+   * instruction, and then the instructions in order, so that the reader knows the type of a value used before
+   * its definition, e.g. by a phi
+   */
+  void writeBody(const Function &function) {
+    locals.clear();
+    blocks.clear();
+    for (auto arg : function.args())
+      locals.emplace(arg.get(), narrow(locals.size()));
+    std::vector<uint32_t> blockWords{};
+    std::vector<uint32_t> instructionTypes{};
+    for (const auto &basicBlock : function.basicBlocks) {
+      blocks.emplace(&basicBlock, narrow(blocks.size()));
+      writeName(blockWords, basicBlock.name());
+      uint32_t size{};
+      basicBlock.forEachInstruction([&](Ref<Instruction> inst) {
+        locals.emplace(inst.get(), narrow(locals.size()));
+        instructionTypes.push_back(typeIndex(*inst->type()));
+        size++;
+      });
+      blockWords.push_back(size);
+    }
+    bodyWords.push_back(narrow(blocks.size()));
+    bodyWords.push_back(narrow(instructionTypes.size()));
+    bodyWords.insert(bodyWords.end(), blockWords.begin(), blockWords.end());
+    bodyWords.insert(bodyWords.end(), instructionTypes.begin(), instructionTypes.end());
+    for (const auto &basicBlock : function.basicBlocks)
+      basicBlock.forEachInstruction([this](Ref<Instruction> inst) {
+        writeInstruction(*inst);
+      });
+  }
+
+  uint32_t valueRef(const Value &value) {
+    if (auto it = locals.find(&value); it != locals.end())
+      return it->second << ValueTagBits | LocalValue;
+    if (auto constant = mystl::dyn_cast<Constant>(&value))
+      return constantIndex(*constant) << ValueTagBits | ConstantValue;
+    if (auto it = globalIndices.find(&value); it != globalIndices.end())
+      return it->second << ValueTagBits | GlobalValue;
+    throw std::runtime_error("value " + value.name() + " does not belong to the function being written");
+  }
+
+  uint32_t blockRef(const BasicBlock &basicBlock) {
+    return blocks.at(&basicBlock);
+  }
+
+  void writeInstruction(const Instruction &inst) {
+    auto &words = bodyWords;
+    words.push_back(inst.opCode);
+    writeName(words, inst.name());
+    if (auto binary = mystl::dyn_cast<BinaryInst>(&inst))
+      words.insert(words.end(), {valueRef(*binary->lhs), valueRef(*binary->rhs)});
+    else if (auto cmp = mystl::dyn_cast<CmpInst>(&inst))
+      words.insert(words.end(), {static_cast<uint32_t>(cmp->predicate()), valueRef(*cmp->lhs), valueRef(*cmp->rhs)});
+    else if (auto alloca = mystl::dyn_cast<AllocaInst>(&inst))
+      words.insert(words.end(), {narrow(alloca->size()), narrow(alloca->alignment())});
+    else if (auto load = mystl::dyn_cast<LoadInst>(&inst))
+      words.push_back(valueRef(*load->pointer));
+    else if (auto store = mystl::dyn_cast<StoreInst>(&inst))
+      words.insert(words.end(), {valueRef(*store->value), valueRef(*store->pointer)});
+    else if (auto gep = mystl::dyn_cast<GepInst>(&inst)) {
+      words.insert(words.end(), {valueRef(*gep->pointer), narrow(gep->indices().size())});
+      for (auto index : gep->indices())
+        words.push_back(valueRef(*index));
+    } else if (auto phi = mystl::dyn_cast<PhiInst>(&inst)) {
+      words.push_back(narrow(phi->incomingValues().size()));
+      for (const auto &incoming : phi->incomingValues())
+        words.insert(words.end(), {blockRef(*incoming.basicBlock), valueRef(*incoming.value)});
+    } else if (auto call = mystl::dyn_cast<CallInst>(&inst)) {
+      words.insert(words.end(), {functionIndices.at(&call->function), narrow(call->realArgs().size())});
+      for (auto arg : call->realArgs())
+        words.push_back(valueRef(*arg));
+    } else if (auto ret = mystl::dyn_cast<RetInst>(&inst))
+      words.push_back(ret->value ? valueRef(*ret->value) : NoValue);
+    else if (auto br = mystl::dyn_cast<BrInst>(&inst)) {
+      words.push_back(br->isConditional());
+      if (br->isConditional())
+        words.push_back(valueRef(br->cond()));
+      words.push_back(blockRef(br->thenBranch()));
+      if (br->isConditional())
+        words.push_back(blockRef(br->elseBranch()));
+    } else
+      throw std::runtime_error("cannot write instruction " + inst.name() + " to bitcode");
+  }
+
+  Module &module;
+  std::vector<uint32_t> bodyWords{}, typeWords{}, constantOffsets{}, constantWords{}, globalWords{};
+  std::string names{};
+  std::unordered_map<std::string_view, uint32_t> nameOffsets{};
+  std::unordered_map<const Type *, uint32_t> typeIndices{};
+  std::unordered_map<const Constant *, uint32_t> constantIndices{};
+  std::unordered_map<const Value *, uint32_t> globalIndices{};
+  std::unordered_map<const Function *, uint32_t> functionIndices{};
+  // the arguments and instructions, and the blocks, of the function being written
+  std::unordered_map<const Value *, uint32_t> locals{};
+  std::unordered_map<const BasicBlock *, uint32_t> blocks{};
+};
+
+// reads words in order, throwing instead of reading past the end of the words
+struct WordCursor {
+  uint32_t next() {
+    if (position >= words.size())
+      throw std::runtime_error("truncated bitcode");
+    return words[position++];
+  }
+  // the size of a list of records of wordsEach words, which must all be left to read
+  uint32_t count(size_t wordsEach = 1) {
+    auto count = next();
+    if (size_t{count} * wordsEach > words.size() - position)
+      throw std::runtime_error("malformed bitcode: a count beyond the end of the words");
+    return count;
+  }
+  std::span<const uint32_t> words;
+  size_t position;
+};
+
+/**
+ * builds the declarations of the module up front and the body of each function when it is materialized,
+ * constants are also created on first use, since most of them are only used by some of the bodies
+ */
+struct BitcodeReader final : Materializer {
+  BitcodeReader(const std::filesystem::path &path, LLVMContext &ctx) : m_file(path), m_ctx(ctx) {
+    if (m_file.size() < sizeof(BitcodeHeader))
+      throw std::runtime_error(path.string() + " is not a bitcode file");
+    std::memcpy(&m_header, m_file.data(), sizeof(m_header));
+    if (m_header.magic != BitcodeHeader::Magic)
+      throw std::runtime_error(path.string() + " is not a bitcode file");
+    if (m_header.version != BitcodeHeader::Version)
+      throw std::runtime_error(path.string() + " was written by another version of the bitcode writer");
+    if (m_file.size() != sizeof(BitcodeHeader) + size_t{m_header.wordCount} * sizeof(uint32_t) + m_header.namesSize)
+      throw std::runtime_error("truncated bitcode");
+    // every record takes at least a word, so the counts are checked before anything is sized by them
+    for (auto count : {m_header.functionCount, m_header.typeCount, m_header.constantCount, m_header.globalCount})
+      if (count > m_header.wordCount)
+        throw std::runtime_error("malformed bitcode: more records than words");
+    // the header is a whole number of words, so the words are as aligned as the mapping
+    m_words = {reinterpret_cast<const uint32_t *>(m_file.data() + sizeof(BitcodeHeader)), m_header.wordCount};
+    m_names = {m_file.data() + sizeof(BitcodeHeader) + m_words.size_bytes(), m_header.namesSize};
+  }
+
+  std::unique_ptr<Module> readDeclarations() {
+    auto module = std::make_unique<Module>();
+    readTypes();
+    m_constants.resize(m_header.constantCount);
+    auto globals = cursor(m_header.globals);
+    for (uint32_t i = 0; i < m_header.globalCount; i++) {
+      auto name = readName(globals);
+      auto type = this->type(globals.next());
+      auto initializer = globals.next();
+      auto isConstant = globals.next() != 0;
+      module->addGlobalVariable(std::make_unique<GlobalVariable>(GlobalVariableDetails{
+          .name = name,
+          .type = type,
+          .initializer = initializer == NoValue ? nullptr : constant(initializer),
+          .isConstant = isConstant,
+      }));
+      m_globals.push_back(module->globalVariables.back());
+    }
+    auto index = cursor(m_header.functionIndex);
+    for (uint32_t i = 0; i < m_header.functionCount; i++) {
+      FunctionEntry entry{};
+      auto words = reinterpret_cast<uint32_t *>(&entry);
+      for (size_t word = 0; word < FunctionEntryWords; word++)
+        words[word] = index.next();
+      auto functionType = mystl::dyn_cast<FunctionType>(type(entry.type));
+      if (!functionType)
+        throw std::runtime_error("malformed bitcode: a function without a function type");
+      auto argCursor = cursor(entry.argNames);
+      std::vector<std::string> argNames{};
+      for (size_t arg = 0; arg < functionType->argCount(); arg++)
+        argNames.push_back(readName(argCursor));
+      module->addFunction(std::make_unique<Function>(FunctionInfo{
+          .name = name(entry.nameOffset, entry.nameSize),
+          .functionType = functionType,
+          .argNames = std::move(argNames),
+          .module = *module,
+      }));
+      auto function = module->functions.back();
+      m_functions.push_back(function);
+      if (entry.bodySize) {
+        function->setMaterializer(mystl::make_observer<Materializer>(this));
+        m_bodies.emplace(function.get(), entry);
+      }
+    }
+    return module;
+  }
+
+  void materialize(Function &function) override {
+    auto it = m_bodies.find(&function);
+    if (it == m_bodies.end())
+      throw std::runtime_error("function " + function.name() + " has no body in its bitcode");
+    // declared out here, so that a partial body that still uses the stand-ins is dropped before they go
+    ForwardRefs forwardRefs{};
+    try {
+      readBody(function, it->second, forwardRefs);
+    } catch (...) {
+      function.dropBody();
+      throw;
+    }
+    m_bodies.erase(it);
+  }
+
+private:
+  // stand-ins for instructions used before they are defined, replaced once the whole body is built
+  using ForwardRefs = std::unordered_map<uint32_t, std::unique_ptr<Argument>>;
+
+  void readBody(Function &function, const FunctionEntry &entry, ForwardRefs &forwardRefs) {
+    WordCursor body{m_words.subspan(0, std::min<size_t>(m_words.size(), size_t{entry.body} + entry.bodySize)),
+                    entry.body};
+    // a block is its name and its size, then every instruction has its type
+    auto blockCount = body.count(3);
+    auto instCount = body.count();
+    std::vector<Ref<BasicBlock>> blocks{};
+    std::vector<uint32_t> blockSizes{};
+    for (uint32_t i = 0; i < blockCount; i++) {
+      blocks.push_back(ref(function.addBasicBlock(readName(body))));
+      blockSizes.push_back(body.next());
+    }
+    auto argCount = function.args().size();
+    std::vector<CRef<Type>> types{};
+    for (uint32_t i = 0; i < instCount; i++)
+      types.push_back(type(body.next()));
+    std::vector<Ref<Value>> locals(argCount + instCount);
+    for (size_t i = 0; i < argCount; i++)
+      locals[i] = function.args()[i];
+    auto value = [&](uint32_t valueRef) -> Ref<Value> {
+      auto index = valueRef >> ValueTagBits;
+      switch (valueRef & ((1u << ValueTagBits) - 1)) {
+      case LocalValue: {
+        if (index >= locals.size())
+          throw std::runtime_error("malformed bitcode: a local value out of range");
+        if (locals[index])
+          return locals[index];
+        auto &forwardRef = forwardRefs[index];
+        if (!forwardRef)
+          forwardRef = std::make_unique<Argument>("", types[index - argCount]);
+        return ref<Value>(*forwardRef);
+      }
+      case ConstantValue:
+        return constant(index);
+      case GlobalValue:
+        if (index >= m_globals.size())
+          throw std::runtime_error("malformed bitcode: a global out of range");
+        return m_globals[index];
+      default:
+        throw std::runtime_error("malformed bitcode: an operand of unknown kind");
+      }
+    };
+    auto block = [&](uint32_t index) {
+      if (index >= blocks.size())
+        throw std::runtime_error("malformed bitcode: a block out of range");
+      return blocks[index];
+    };
+    size_t next = argCount;
+    for (uint32_t i = 0; i < blockCount; i++)
+      for (uint32_t j = 0; j < blockSizes[i]; j++, next++) {
+        if (next >= locals.size())
+          throw std::runtime_error("malformed bitcode: more instructions than declared");
+        locals[next] = readInstruction(body, *blocks[i], types[next - argCount], value, block);
+      }
+    for (auto &[index, forwardRef] : forwardRefs)
+      forwardRef->replaceAllUsesWith(locals[index]);
+  }
+
+  WordCursor cursor(uint32_t position) const {
+    return {m_words, position};
+  }
+
+  std::string name(uint32_t offset, uint32_t size) const {
+    if (size_t{offset} + size > m_names.size())
+      throw std::runtime_error("malformed bitcode: a name out of range");
+    return std::string(m_names.substr(offset, size));
+  }
+  std::string readName(WordCursor &words) const {
+    auto offset = words.next();
+    return name(offset, words.next());
+  }
+
+  CRef<Type> type(uint32_t index) const {
+    if (index >= m_types.size())
+      throw std::runtime_error("malformed bitcode: a type out of range");
+    return m_types[index];
+  }
+
+  void readTypes() {
+    auto types = cursor(m_header.types);
+    for (uint32_t i = 0; i < m_header.typeCount; i++) {
+      switch (static_cast<Type::TypeEnum>(types.next())) {
+      case Type::TypeEnum::Void:
+        m_types.push_back(m_ctx.voidType());
+        break;
+      case Type::TypeEnum::Float:
+        m_types.push_back(m_ctx.floatType());
+        break;
+      case Type::TypeEnum::Double:
+        m_types.push_back(m_ctx.doubleType());
+        break;
+      case Type::TypeEnum::Integer: {
+        auto bitWidth = types.next();
+        if (bitWidth == 1)
+          m_types.push_back(m_ctx.boolType());
+        else if (bitWidth == 32)
+          m_types.push_back(m_ctx.intType());
+        else if (bitWidth == 64)
+          m_types.push_back(m_ctx.longType());
+        else
+          throw std::runtime_error("malformed bitcode: an integer type of unsupported width");
+        break;
+      }
+      case Type::TypeEnum::Array: {
+        auto elementType = type(types.next());
+        m_types.push_back(m_ctx.arrayType(elementType, types.next()));
+        break;
+      }
+      case Type::TypeEnum::Pointer:
+        m_types.push_back(m_ctx.pointerType(type(types.next())));
+        break;
+      case Type::TypeEnum::Function: {
+        std::vector<CRef<Type>> containedTypes(types.count());
+        if (containedTypes.empty())
+          throw std::runtime_error("malformed bitcode: a function type without a return type");
+        for (auto &containedType : containedTypes)
+          containedType = type(types.next());
+        m_types.push_back(m_ctx.functionType(containedTypes));
+        break;
+      }
+      default:
+        throw std::runtime_error("malformed bitcode: a type of unknown kind");
+      }
+    }
+  }
+
+  Ref<Constant> constant(uint32_t index) {
+    if (index >= m_constants.size())
+      throw std::runtime_error("malformed bitcode: a constant out of range");
+    if (m_constants[index])
+      return m_constants[index];
+    auto offset = cursor(m_header.constantIndex + index).next();
+    auto record = cursor(offset);
+    auto tag = record.next();
+    auto type = this->type(record.next());
+    Ref<Constant> result{};
+    if (tag == ArrayConstant) {
+      auto arrayType = mystl::dyn_cast<ArrayType>(type);
+      if (!arrayType)
+        throw std::runtime_error("malformed bitcode: an array constant without an array type");
+      std::vector<CRef<Constant>> elements(record.count());
+      for (auto &element : elements)
+        element = constant(record.next());
+      result = m_ctx.constantArray(arrayType, elements);
+    } else if (tag == ScalarConstant) {
+      uint64_t bits = record.next();
+      bits |= uint64_t{record.next()} << 32;
+      if (type->isInteger())
+        result = m_ctx.intConstant(type, static_cast<int64_t>(bits));
+      else if (type->type == Type::TypeEnum::Float)
+        result = m_ctx.floatConstant(type, std::bit_cast<float>(static_cast<uint32_t>(bits)));
+      else
+        result = m_ctx.floatConstant(type, std::bit_cast<double>(bits));
+    } else
+      throw std::runtime_error("malformed bitcode: a constant of unknown kind");
+    return m_constants[index] = result;
+  }
+
+  template<typename ValueOf, typename BlockOf>
+  Ref<Value> readInstruction(WordCursor &words, BasicBlock &basicBlock, CRef<Type> type,
+                             ValueOf &&value, BlockOf &&block) {
+    auto op = words.next();
+    auto name = readName(words);
+    switch (op) {
+    case Instruction::Add: case Instruction::Sub: case Instruction::Mul: case Instruction::SDiv:
+    case Instruction::SRem: case Instruction::Xor: case Instruction::Shl: case Instruction::LShr:
+    case Instruction::AShr: case Instruction::FAdd: case Instruction::FSub: case Instruction::FMul:
+    case Instruction::FDiv: {
+      auto lhs = value(words.next());
+      auto rhs = value(words.next());
+      return basicBlock.createInstruction<BinaryInst>(static_cast<uint8_t>(op), basicBlock, BinaryInstDetails{
+          .name = name, .type = type, .lhs = lhs, .rhs = rhs});
+    }
+    case Instruction::ICmp: case Instruction::FCmp: {
+      auto predicate = static_cast<Predicate>(words.next());
+      auto lhs = value(words.next());
+      auto rhs = value(words.next());
+      return basicBlock.createInstruction<CmpInst>(static_cast<uint8_t>(op), basicBlock, CmpInstDetails{
+          .ctx = m_ctx, .name = name, .lhs = lhs, .rhs = rhs, .predicate = predicate});
+    }
+    case Instruction::Alloca: {
+      auto size = words.next();
+      auto alignment = words.next();
+      auto alloca = basicBlock.createInstruction<AllocaInst>(basicBlock, AllocaInstDetails{
+          .name = name, .type = type, .size = size, .alignment = alignment});
+      basicBlock.function().addLocalVar(alloca);
+      return alloca;
+    }
+    case Instruction::Load:
+      return basicBlock.createInstruction<LoadInst>(basicBlock, MemInstDetails{
+          .name = name, .type = type, .pointer = value(words.next())});
+    case Instruction::Store: {
+      auto stored = value(words.next());
+      auto pointer = value(words.next());
+      return basicBlock.createInstruction<StoreInst>(basicBlock, StoreInstDetails{
+          .type = type, .value = stored, .pointer = pointer});
+    }
+    case Instruction::Gep: {
+      auto pointer = value(words.next());
+      std::vector<Ref<Value>> indices(words.count());
+      for (auto &index : indices)
+        index = value(words.next());
+      return basicBlock.createInstruction<GepInst>(basicBlock, GepInstDetails{
+          .name = name, .type = type, .pointer = pointer, .indices = std::move(indices)});
+    }
+    case Instruction::Phi: {
+      std::vector<PhiValue> incomingValues(words.count(2));
+      for (auto &incoming : incomingValues) {
+        incoming.basicBlock = block(words.next());
+        incoming.value = value(words.next());
+      }
+      return basicBlock.createInstruction<PhiInst>(basicBlock, PhiInstDetails{
+          .name = name, .type = type, .incomingValues = std::move(incomingValues)});
+    }
+    case Instruction::Call: {
+      auto callee = words.next();
+      if (callee >= m_functions.size())
+        throw std::runtime_error("malformed bitcode: a callee out of range");
+      std::vector<Ref<Value>> realArgs(words.count());
+      for (auto &arg : realArgs)
+        arg = value(words.next());
+      return basicBlock.createInstruction<CallInst>(basicBlock, CallInstDetails{
+          .name = name, .type = type, .function = *m_functions[callee], .realArgs = realArgs});
+    }
+    case Instruction::Ret: {
+      auto returned = words.next();
+      return basicBlock.createInstruction<RetInst>(basicBlock, RetInstDetails{
+          .ctx = m_ctx, .value = returned == NoValue ? nullptr : value(returned)});
+    }
+    case Instruction::Br: {
+      if (!words.next())
+        return basicBlock.createInstruction<BrInst>(basicBlock, m_ctx, block(words.next()));
+      auto cond = value(words.next());
+      auto thenBranch = block(words.next());
+      auto elseBranch = block(words.next());
+      return basicBlock.createInstruction<BrInst>(basicBlock, m_ctx, BrInst::Conditional{
+          .cond = cond, .thenBranch = thenBranch, .elseBranch = elseBranch});
+    }
+    default:
+      throw std::runtime_error("malformed bitcode: an instruction of unknown opcode");
+    }
+  }
+
+  MappedFile m_file;
+  LLVMContext &m_ctx;
+  BitcodeHeader m_header{};
+  std::span<const uint32_t> m_words{};
+  std::string_view m_names{};
+  std::vector<CRef<Type>> m_types{};
+  // null until first used
+  std::vector<Ref<Constant>> m_constants{};
+  std::vector<Ref<GlobalVariable>> m_globals{};
+  std::vector<Ref<Function>> m_functions{};
+  // the index entries of the functions that are yet to be materialized
+  std::unordered_map<const Function *, FunctionEntry> m_bodies{};
+};
+
+}
+
+void writeBitcode(Module &module, const std::filesystem::path &path) {
+  BitcodeWriter(module).write(path);
+}
+
+std::unique_ptr<Module> readBitcode(const std::filesystem::path &path, LLVMContext &ctx) {
+  auto reader = std::make_unique<BitcodeReader>(path, ctx);
+  auto module = reader->readDeclarations();
+  module->setMaterializer(std::move(reader));
+  return module;
+}
+
+bool isBitcode(const std::filesystem::path &path) {
+  std::ifstream file(path, std::ios::binary);
+  uint32_t magic{};
+  file.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  return file && magic == BitcodeHeader::Magic;
+}
+
+}
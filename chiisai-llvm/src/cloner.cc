@@ -0,0 +1,170 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <vector>
+#include <stdexcept>
+#include <unordered_map>
+#include <chiisai-llvm/cloner.h>
+#include <chiisai-llvm/function.h>
+#include <chiisai-llvm/instruction.h>
+#include <chiisai-llvm/llvm-context.h>
+#include <chiisai-llvm/mystl/castings.h>
+
+namespace llvm {
+
+namespace {
+
+/**
+ * values and blocks of the original are mapped through vectors indexed by their dense indices,
+ * an operand defined later than its use, e.g. by a phi, is read through a stand-in that is replaced
+ * once its definition has been copied
+ */
+struct FunctionCloner {
+  FunctionCloner(Function &original, Function &clone, const LLVMContext &ctx)
+      : original(original), clone(clone), ctx(ctx),
+        values(original.valueIndexBound()), blocks(original.blockIndexBound()) {}
+
+  void mapArgument(const Argument &arg, Ref<Value> value) {
+    values[arg.localIndex()] = value;
+  }
+
+  void cloneBody() {
+    for (auto &basicBlock : original.basicBlocks)
+      blocks[basicBlock.index()] = ref(clone.addBasicBlock(basicBlock.name()));
+    for (auto &basicBlock : original.basicBlocks) {
+      auto &target = *blocks[basicBlock.index()];
+      basicBlock.forEachInstruction([&](Ref<Instruction> inst) {
+        values[inst->localIndex()] = cloneInstruction(*inst, target);
+      });
+    }
+    for (auto &[index, standIn] : standIns)
+      standIn->replaceAllUsesWith(values[index]);
+  }
+
+private:
+  Ref<Value> map(Ref<Value> value) {
+    if (!value || !value->hasLocalIndex())
+      return value;
+    auto index = value->localIndex();
+    if (values[index])
+      return values[index];
+    auto &standIn = standIns[index];
+    if (!standIn)
+      standIn = std::make_unique<Argument>("", value->type());
+    return ref<Value>(*standIn);
+  }
+  Ref<BasicBlock> map(const BasicBlock &basicBlock) {
+    return blocks[basicBlock.index()];
+  }
+
+  Ref<Instruction> cloneInstruction(const Instruction &inst, BasicBlock &target) {
+    const auto &name = inst.name();
+    if (auto binary = mystl::dyn_cast<BinaryInst>(&inst))
+      return target.createInstruction<BinaryInst>(binary->opCode, target, BinaryInstDetails{
+          .name = name, .type = binary->type(), .lhs = map(binary->lhs), .rhs = map(binary->rhs)});
+    if (auto cmp = mystl::dyn_cast<CmpInst>(&inst))
+      return target.createInstruction<CmpInst>(cmp->opCode, target, CmpInstDetails{
+          .ctx = ctx, .name = name, .lhs = map(cmp->lhs), .rhs = map(cmp->rhs), .predicate = cmp->predicate()});
+    if (auto alloca = mystl::dyn_cast<AllocaInst>(&inst)) {
+      auto copy = target.createInstruction<AllocaInst>(target, AllocaInstDetails{
+          .name = name, .type = alloca->type(), .size = alloca->size(), .alignment = alloca->alignment()});
+      clone.addLocalVar(copy);
+      return copy;
+    }
+    if (auto load = mystl::dyn_cast<LoadInst>(&inst))
+      return target.createInstruction<LoadInst>(target, MemInstDetails{
+          .name = name, .type = load->type(), .pointer = map(load->pointer)});
+    if (auto store = mystl::dyn_cast<StoreInst>(&inst))
+      return target.createInstruction<StoreInst>(target, StoreInstDetails{
+          .type = store->type(), .value = map(store->value), .pointer = map(store->pointer)});
+    if (auto gep = mystl::dyn_cast<GepInst>(&inst)) {
+      std::vector<Ref<Value>> indices{};
+      indices.reserve(gep->indices().size());
+      for (auto index : gep->indices())
+        indices.push_back(map(index));
+      return target.createInstruction<GepInst>(target, GepInstDetails{
+          .name = name, .type = gep->type(), .pointer = map(gep->pointer), .indices = std::move(indices)});
+    }
+    if (auto phi = mystl::dyn_cast<PhiInst>(&inst)) {
+      std::vector<PhiValue> incomingValues{};
+      incomingValues.reserve(phi->incomingValues().size());
+      for (const auto &incoming : phi->incomingValues())
+        incomingValues.push_back({.basicBlock = map(*incoming.basicBlock), .value = map(incoming.value)});
+      return target.createInstruction<PhiInst>(target, PhiInstDetails{
+          .name = name, .type = phi->type(), .incomingValues = std::move(incomingValues)});
+    }
+    if (auto call = mystl::dyn_cast<CallInst>(&inst)) {
+      std::vector<Ref<Value>> realArgs{};
+      realArgs.reserve(call->realArgs().size());
+      for (auto arg : call->realArgs())
+        realArgs.push_back(map(arg));
+      return target.createInstruction<CallInst>(target, CallInstDetails{
+          .name = name, .type = call->type(), .function = call->function, .realArgs = realArgs});
+    }
+    if (auto ret = mystl::dyn_cast<RetInst>(&inst))
+      return target.createInstruction<RetInst>(target, RetInstDetails{.ctx = ctx, .value = map(ret->value)});
+    if (auto br = mystl::dyn_cast<BrInst>(&inst)) {
+      if (!br->isConditional())
+        return target.createInstruction<BrInst>(target, ctx, map(br->thenBranch()));
+      return target.createInstruction<BrInst>(target, ctx, BrInst::Conditional{
+          .cond = map(mystl::make_observer(const_cast<Value *>(&br->cond()))),
+          .thenBranch = map(br->thenBranch()),
+          .elseBranch = map(br->elseBranch())});
+    }
+    throw std::runtime_error("cannot clone instruction " + inst.name());
+  }
+
+  Function &original;
+  Function &clone;
+  const LLVMContext &ctx;
+  std::vector<Ref<Value>> values;
+  std::vector<Ref<BasicBlock>> blocks;
+  std::unordered_map<uint32_t, std::unique_ptr<Argument>> standIns{};
+};
+
+}
+
+std::unique_ptr<Function> specializeFunction(Function &function, const std::string &name,
+                                             std::span<const Ref<Value>> argValues, LLVMContext &ctx) {
+  const auto &args = function.args();
+  if (argValues.size() != args.size())
+    throw std::runtime_error("specializing " + function.name() + " needs one value or null per argument");
+  function.materialize();
+  // the dense indices of the original index the maps of the cloner
+  if (!function.isCanonicallyNumbered())
+    function.renumber();
+  const auto &functionType = mystl::cast<FunctionType>(*function.type());
+  std::vector<CRef<Type>> containedTypes{functionType.returnValueType()};
+  std::vector<std::string> argNames{};
+  for (size_t i = 0; i < args.size(); i++) {
+    if (argValues[i] && argValues[i]->type() != args[i]->type())
+      throw std::runtime_error("specializing argument " + args[i]->name() + " of " + function.name()
+                                   + " with a value of another type");
+    if (argValues[i])
+      continue;
+    containedTypes.push_back(args[i]->type());
+    argNames.push_back(args[i]->name());
+  }
+  // the signature is only interned anew if some argument is dropped
+  auto clonedType = argNames.size() == args.size() ? mystl::cast<FunctionType>(function.type())
+                                                   : ctx.functionType(containedTypes);
+  auto clone = std::make_unique<Function>(FunctionInfo{
+      .name = name,
+      .functionType = clonedType,
+      .argNames = std::move(argNames),
+      .module = function.module(),
+  });
+  FunctionCloner cloner(function, *clone, ctx);
+  for (size_t i = 0, kept = 0; i < args.size(); i++)
+    cloner.mapArgument(*args[i], argValues[i] ? argValues[i] : Ref<Value>(clone->args()[kept++]));
+  if (!function.isDeclaration())
+    cloner.cloneBody();
+  return clone;
+}
+
+std::unique_ptr<Function> cloneFunction(Function &function, const std::string &name, LLVMContext &ctx) {
+  std::vector<Ref<Value>> keepAll(function.args().size());
+  return specializeFunction(function, name, keepAll, ctx);
+}
+
+}
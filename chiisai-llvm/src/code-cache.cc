@@ -0,0 +1,87 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <cstdio>
+#include <string>
+#include <stdexcept>
+#include <chiisai-llvm/code-cache.h>
+#include <chiisai-llvm/module.h>
+#include <chiisai-llvm/function.h>
+#include <chiisai-llvm/bitcode.h>
+#include <chiisai-llvm/mystl/hash.h>
+#include <minilog/logger.h>
+#if defined(__unix__)
+#include <unistd.h>
+#endif
+
+#ifndef CHIISAI_LLVM_BUILD_ID
+#define CHIISAI_LLVM_BUILD_ID ""
+#endif
+
+namespace llvm {
+
+std::string_view CodeCache::buildId() {
+  return CHIISAI_LLVM_BUILD_ID;
+}
+
+CodeCache::CodeCache(std::filesystem::path directory) : m_directory(std::move(directory)) {
+  std::filesystem::create_directories(m_directory);
+}
+
+uint64_t CodeCache::key(std::string_view source) {
+  auto hashCode = mystl::fnv1a(buildId());
+  // an artifact of another bitcode version would be rejected by readBitcode anyway, but would never be replaced
+  auto version = std::to_string(EngineVersion) + "." + std::to_string(BitcodeVersion);
+  hashCode = mystl::fnv1a(version, hashCode);
+  return mystl::fnv1a(source, hashCode);
+}
+
+std::filesystem::path CodeCache::artifactPath(uint64_t key) const {
+  char fileName[32];
+  std::snprintf(fileName, sizeof(fileName), "%016llx.bc", static_cast<unsigned long long>(key));
+  return m_directory / fileName;
+}
+
+std::unique_ptr<Module> CodeCache::load(std::string_view source, LLVMContext &ctx) {
+  auto path = artifactPath(key(source));
+  std::error_code error;
+  if (!std::filesystem::exists(path, error)) {
+    m_stats.misses++;
+    return nullptr;
+  }
+  try {
+    auto module = readBitcode(path, ctx);
+    m_stats.hits++;
+    return module;
+  } catch (const std::runtime_error &e) {
+    minilog::warn("ignoring the code cache artifact {}: {}", path.string(), e.what());
+    m_stats.rejected++;
+    return nullptr;
+  }
+}
+
+void CodeCache::store(std::string_view source, Module &module) {
+  auto path = artifactPath(key(source));
+  auto temporary = path;
+#if defined(__unix__)
+  temporary += ".tmp" + std::to_string(getpid());
+#else
+  temporary += ".tmp" + std::to_string(reinterpret_cast<uintptr_t>(this));
+#endif
+  std::error_code error;
+  try {
+    writeBitcode(module, temporary);
+  } catch (const std::runtime_error &e) {
+    minilog::warn("failed to write {} to the code cache: {}", path.string(), e.what());
+    std::filesystem::remove(temporary, error);
+    return;
+  }
+  std::filesystem::rename(temporary, path, error);
+  if (error) {
+    std::filesystem::remove(temporary, error);
+    return;
+  }
+  m_stats.stores++;
+}
+
+}
@@ -0,0 +1,147 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <bit>
+#include <charconv>
+#include <stdexcept>
+#include <algorithm>
+#include <chiisai-llvm/constant-pool.h>
+#include <chiisai-llvm/integer-type.h>
+#include <chiisai-llvm/mystl/hash.h>
+#include <chiisai-llvm/mystl/castings.h>
+
+namespace llvm {
+
+namespace {
+template<typename T>
+bool parse(std::string_view literal, T &value, int base = 10) {
+  if (literal.starts_with('+'))
+    literal.remove_prefix(1);
+  auto [end, error] = std::from_chars(literal.data(), literal.data() + literal.size(), value, base);
+  return error == std::errc{} && end == literal.data() + literal.size();
+}
+bool parse(std::string_view literal, double &value) {
+  if (literal.starts_with('+'))
+    literal.remove_prefix(1);
+  auto [end, error] = std::from_chars(literal.data(), literal.data() + literal.size(), value);
+  return error == std::errc{} && end == literal.data() + literal.size();
+}
+
+// the shortest spelling that reads back as the same value, and that still reads as a floating point literal
+template<typename T>
+std::string spellFloating(T value) {
+  char buffer[64];
+  auto end = std::to_chars(buffer, buffer + sizeof(buffer), value).ptr;
+  std::string spelling(buffer, end);
+  if (spelling.find_first_of(".ein") == std::string::npos)
+    spelling += ".0";
+  return spelling;
+}
+
+std::string spell(const Type &type, uint64_t bits) {
+  if (type.isInteger()) {
+    if (mystl::cast<IntegerType>(type).bitWidth() == 1)
+      return bits ? "true" : "false";
+    return std::to_string(static_cast<int64_t>(bits));
+  }
+  if (type.type == Type::TypeEnum::Float)
+    return spellFloating(std::bit_cast<float>(static_cast<uint32_t>(bits)));
+  return spellFloating(std::bit_cast<double>(bits));
+}
+}
+
+size_t ConstantPool::ScalarKeyHash::operator()(const ScalarKey &key) const {
+  size_t hashCode{};
+  mystl::hash_combine(hashCode, key.type);
+  mystl::hash_combine(hashCode, key.bits);
+  return hashCode;
+}
+
+size_t ConstantPool::ArrayHash::operator()(const ArrayView &view) const {
+  size_t hashCode{};
+  mystl::hash_combine(hashCode, view.type);
+  for (auto element : view.elements)
+    mystl::hash_combine(hashCode, element.get());
+  return hashCode;
+}
+
+size_t ConstantPool::ArrayHash::operator()(const std::unique_ptr<ConstantArray> &array) const {
+  return (*this)(ArrayView{array->type()->id(), array->elements()});
+}
+
+bool ConstantPool::ArrayEqual::operator()(const ArrayView &lhs, const std::unique_ptr<ConstantArray> &rhs) const {
+  return lhs.type == rhs->type()->id() && std::ranges::equal(lhs.elements, rhs->elements());
+}
+
+Ref<ConstantScalar> ConstantPool::canonical(CRef<Type> type, uint64_t bits) {
+  // a spelling that throws leaves nothing behind, since the constant is made before it is recorded
+  return ref(m_scalars.intern(ScalarKey{type->id(), bits}, [&] {
+    return std::make_unique<ConstantScalar>(spell(*type, bits), type, bits);
+  }));
+}
+
+Ref<ConstantScalar> ConstantPool::integer(CRef<Type> type, int64_t value) {
+  if (!type->isInteger())
+    throw std::runtime_error("an integer constant needs an integer type");
+  auto bitWidth = mystl::cast<IntegerType>(*type).bitWidth();
+  auto bits = static_cast<uint64_t>(value);
+  if (bitWidth == 1)
+    bits &= 1;
+  else if (bitWidth < 64)
+    bits = static_cast<uint64_t>(static_cast<int64_t>(bits << (64 - bitWidth)) >> (64 - bitWidth));
+  return canonical(type, bits);
+}
+
+Ref<ConstantScalar> ConstantPool::floating(CRef<Type> type, double value) {
+  if (type->type == Type::TypeEnum::Float)
+    return canonical(type, std::bit_cast<uint32_t>(static_cast<float>(value)));
+  if (type->type == Type::TypeEnum::Double)
+    return canonical(type, std::bit_cast<uint64_t>(value));
+  throw std::runtime_error("a floating point constant needs a floating point type");
+}
+
+Ref<ConstantScalar> ConstantPool::scalar(CRef<Type> type, std::string_view literal) {
+  if (type->isInteger()) {
+    if (mystl::cast<IntegerType>(*type).bitWidth() == 1 && (literal == "true" || literal == "false"))
+      return integer(type, literal == "true");
+    int64_t value{};
+    if (!parse(literal, value))
+      throw std::runtime_error("malformed integer constant " + std::string(literal));
+    return integer(type, value);
+  }
+  if (type->isFloatingPoint()) {
+    // like in LLVM, a hexadecimal literal is the bit pattern of a double, whatever the type
+    if (literal.starts_with("0x") || literal.starts_with("0X")) {
+      uint64_t bits{};
+      if (!parse(literal.substr(2), bits, 16))
+        throw std::runtime_error("malformed floating point constant " + std::string(literal));
+      return floating(type, std::bit_cast<double>(bits));
+    }
+    double value{};
+    if (!parse(literal, value))
+      throw std::runtime_error("malformed floating point constant " + std::string(literal));
+    return floating(type, value);
+  }
+  throw std::runtime_error("constant " + std::string(literal) + " is not of a scalar type");
+}
+
+Ref<ConstantArray> ConstantPool::array(CRef<ArrayType> type, std::span<const CRef<Constant>> elements) {
+  if (elements.size() > type->size)
+    throw std::runtime_error("too many elements in a constant array");
+  for (auto element : elements)
+    if (element->type() != type->elementType())
+      throw std::runtime_error("element " + element->name() + " does not have the element type of the array");
+  std::lock_guard lock(m_arraysMutex);
+  if (auto it = m_arrays.find(ArrayView{type->id(), elements}); it != m_arrays.end())
+    return mystl::make_observer(it->get());
+  std::string name = "[";
+  for (auto element : elements) {
+    if (name.size() > 1)
+      name += ", ";
+    name += element->name();
+  }
+  name += "]";
+  return mystl::make_observer(m_arrays.emplace(std::make_unique<ConstantArray>(name, type, elements)).first->get());
+}
+
+}
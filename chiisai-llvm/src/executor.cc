@@ -0,0 +1,266 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <memory>
+#include <algorithm>
+#include <chiisai-llvm/executor.h>
+#include <chiisai-llvm/function.h>
+#include <chiisai-llvm/module.h>
+#include <chiisai-llvm/llvm-context.h>
+#include <chiisai-llvm/constant-scalar.h>
+#include <chiisai-llvm/constant-array.h>
+#include <chiisai-llvm/array-type.h>
+#include <chiisai-llvm/global-variable.h>
+#include <chiisai-llvm/mystl/castings.h>
+
+namespace llvm {
+
+// number of scalar cells an object of the given type occupies
+static size_t cellCount(const Type &type) {
+  if (type.isArray()) {
+    const auto &arrayType = mystl::cast<ArrayType>(type);
+    return arrayType.size * cellCount(*arrayType.elementType());
+  }
+  return 1;
+}
+
+static const Type &scalarType(const Type &type) {
+  if (type.isArray())
+    return scalarType(*mystl::cast<ArrayType>(type).elementType());
+  return type;
+}
+
+static Result zeroResult(const Type &type) {
+  if (type.isInteger()) {
+    auto bitWidth = mystl::cast<IntegerType>(type).bitWidth();
+    if (bitWidth == 1)
+      return Result{false};
+    if (bitWidth == 32)
+      return Result{int32_t{}};
+    return Result{int64_t{}};
+  }
+  if (type.type == Type::TypeEnum::Float)
+    return Result{float{}};
+  if (type.type == Type::TypeEnum::Double)
+    return Result{double{}};
+  if (type.isPointer())
+    return Result{Address{}};
+  throw std::runtime_error("cannot create a value of a non-scalar type");
+}
+
+static Result constantResult(const Constant &constant) {
+  auto scalar = mystl::dyn_cast<ConstantScalar>(&constant);
+  if (!scalar)
+    throw std::runtime_error("constant " + constant.name() + " is not a scalar");
+  const auto &type = *constant.type();
+  if (type.isInteger()) {
+    auto bitWidth = mystl::cast<IntegerType>(type).bitWidth();
+    if (bitWidth == 1)
+      return Result{scalar->boolValue()};
+    if (bitWidth == 32)
+      return Result{static_cast<int32_t>(scalar->intValue())};
+    return Result{scalar->intValue()};
+  }
+  if (type.type == Type::TypeEnum::Float)
+    return Result{scalar->floatValue()};
+  return Result{scalar->doubleValue()};
+}
+
+// writes the scalars of a constant to the first of count consecutive cells, returning how many were written
+static size_t initializeCells(Result *cells, size_t count, const Constant &constant) {
+  auto written = cellCount(*constant.type());
+  if (written > count)
+    throw std::runtime_error("constant " + constant.name() + " does not fit the memory it initializes");
+  auto array = mystl::dyn_cast<ConstantArray>(&constant);
+  if (!array) {
+    *cells = constantResult(constant);
+    return 1;
+  }
+  const auto &arrayType = mystl::cast<ArrayType>(*array->type());
+  auto elementCells = cellCount(*arrayType.elementType());
+  if (array->elements().size() > arrayType.size)
+    throw std::runtime_error("constant " + constant.name() + " has more elements than its type");
+  // elements that are not listed stay zero
+  for (size_t i = 0; i < array->elements().size(); i++)
+    initializeCells(cells + i * elementCells, count - i * elementCells, *array->elements()[i]);
+  return written;
+}
+
+Executor &Executor::prepare() {
+  if (m_prepared)
+    return *this;
+  // functions that are not materialized yet are translated when they are first called
+  for (auto function : module.functions)
+    if (!function->isDeclaration() && function->isMaterialized())
+      translate(*function);
+  allocateDataSegment();
+  m_prepared = true;
+  return *this;
+}
+
+const FrameLayout &Executor::translate(Function &function) {
+  auto it = m_layouts.find(cref(function));
+  if (it != m_layouts.end() && it->second.revision == function.revision())
+    return it->second;
+  function.materialize();
+  if (!function.isCanonicallyNumbered())
+    function.renumber();
+  FrameLayout layout{.slotCount = function.valueIndexBound(), .blockCount = function.blockIndexBound(),
+                     .revision = function.revision()};
+  auto nameSlot = [&layout](const Value &value) {
+    if (!value.symbol().empty())
+      layout.namedSlots.emplace(value.symbol(), value.localIndex());
+  };
+  for (auto arg : function.args())
+    nameSlot(*arg);
+  for (const auto &basicBlock : function.basicBlocks)
+    basicBlock.forEachInstruction([&](Ref<Instruction> inst) {
+      nameSlot(*inst);
+    });
+  // a stale layout is replaced in place, since the frames of the function refer to it
+  if (it != m_layouts.end())
+    return it->second = std::move(layout);
+  return m_layouts.emplace(cref(function), std::move(layout)).first->second;
+}
+
+static_assert(std::is_trivially_destructible_v<Result>, "memory cells are released without running destructors");
+
+Result *Executor::allocateCells(size_t count, const Result &initial) {
+  auto cells = static_cast<Result *>(m_memory.allocate(count * sizeof(Result), alignof(Result)));
+  std::uninitialized_fill_n(cells, count, initial);
+  return cells;
+}
+
+void Executor::allocateDataSegment() {
+  // the data segment is allocated before any frame is pushed, so it is never released
+  for (auto global : module.globalVariables) {
+    const auto &type = *global->type();
+    auto initializer = global->initializer();
+    auto count = cellCount(type);
+    auto base = allocateCells(count, zeroResult(scalarType(type)));
+    if (initializer)
+      initializeCells(base, count, *initializer);
+    m_nonLocalResults.insert_or_assign(cref<Value>(*global), Result{Address{.base = base, .index = 0}});
+  }
+}
+
+std::optional<Result> Executor::call(Function &callee, std::span<const Result> args) {
+  auto function = ref(callee);
+  // once a function has been optimized for a hot loop, later calls enter the optimized version directly
+  if (auto it = m_optimizedVersions.find(function); it != m_optimizedVersions.end() && it->second)
+    function = it->second;
+  return invoke(*function, args);
+}
+
+std::optional<Result> Executor::invoke(Function &function, std::span<const Result> args) {
+  if (auto native = nativeFunction(function)) {
+    if (args.size() != native->arity)
+      throw std::runtime_error("wrong number of arguments passed to native function " + function.name());
+    NativeFunction::Args nativeArgs{};
+    for (size_t i = 0; i < args.size(); i++)
+      nativeArgs[i] = &args[i];
+    return native->call(nativeArgs);
+  }
+  if (args.size() != function.args().size())
+    throw std::runtime_error("wrong number of arguments passed to function " + function.name());
+  pushFrame(function);
+  for (size_t i = 0; i < args.size(); i++)
+    setReg(*function.args()[i], args[i]);
+  if (m_perfMap) {
+    std::pair<Executor *, Function *> context{this, &function};
+    m_perfMap->run(function, [](void *opaque) {
+      auto [executor, function] = *static_cast<std::pair<Executor *, Function *> *>(opaque);
+      executor->execute(*function);
+    }, &context);
+  } else
+    execute(function);
+  auto returnValue = callFrames.top().returnValue;
+  popFrame();
+  return returnValue;
+}
+
+Ref<Function> Executor::optimizedVersion(Function &function) {
+  auto it = m_optimizedVersions.find(cref(function));
+  if (it != m_optimizedVersions.end())
+    return it->second;
+  auto optimized = m_osrCompiler(function);
+  m_optimizedVersions.emplace(cref(function), optimized);
+  if (optimized)
+    m_optimizedVersions.emplace(cref(*optimized), nullptr);
+  return optimized;
+}
+
+Ref<BasicBlock> Executor::onBackEdge(Ref<BasicBlock> header) {
+  if (++m_backEdgeCounts[header] != m_osrThreshold)
+    return header;
+  auto optimized = optimizedVersion(header->function());
+  if (!optimized)
+    return header;
+  auto target = std::find_if(optimized->basicBlocks.begin(), optimized->basicBlocks.end(),
+                             [&header](const BasicBlock &basicBlock) { return basicBlock.symbol() == header->symbol(); });
+  if (target == optimized->basicBlocks.end())
+    return header;
+  // transfer the live state by name, the frame keeps its memory so that addresses held in registers stay valid
+  auto &baseline = callFrames.top();
+  CallFrame frame{translate(*optimized), baseline.memoryMark};
+  for (const auto &[name, slot] : baseline.layout.namedSlots) {
+    assert(slot < baseline.regs.size());
+    if (!baseline.regs[slot])
+      continue;
+    if (auto it = frame.layout.namedSlots.find(name); it != frame.layout.namedSlots.end()) {
+      assert(it->second < frame.regs.size());
+      frame.regs[it->second] = baseline.regs[slot];
+    }
+  }
+  callFrames.pop();
+  callFrames.push(std::move(frame));
+  minilog::info("on-stack replacement of {} at loop header {}", optimized->name(), header->name());
+  return ref(*target);
+}
+
+const Result &Executor::reg(const Value &value) {
+  auto &frame = callFrames.top();
+  // only the arguments and instructions of the running function have a local index
+  if (value.hasLocalIndex()) {
+    assert(value.localIndex() < frame.regs.size() && "register out of the frame, the function changed while running");
+    const auto &result = frame.regs[value.localIndex()];
+    if (!result)
+      throw std::runtime_error("reading " + value.name() + " before it is defined");
+    return *result;
+  }
+  auto it = m_nonLocalResults.find(cref(value));
+  if (it != m_nonLocalResults.end())
+    return it->second;
+  if (auto constant = mystl::dyn_cast<Constant>(&value))
+    return m_nonLocalResults.emplace(cref(value), constantResult(*constant)).first->second;
+  throw std::runtime_error("value " + value.name() + " is not defined in the current frame");
+}
+
+const Result &Executor::reg(const std::string &name) {
+  auto &frame = callFrames.top();
+  auto symbol = ctx.symbols().find(name);
+  if (!symbol || !frame.layout.namedSlots.contains(*symbol))
+    throw std::runtime_error("value " + name + " is not defined in the current frame");
+  auto slot = frame.layout.namedSlots.at(*symbol);
+  assert(slot < frame.regs.size() && "register out of the frame, the function changed while running");
+  const auto &result = frame.regs[slot];
+  if (!result)
+    throw std::runtime_error("reading " + name + " before it is defined");
+  return *result;
+}
+
+Address Executor::allocate(const Type &type, size_t count) {
+  return Address{.base = allocateCells(cellCount(type) * count, zeroResult(scalarType(type))), .index = 0};
+}
+
+Executor &Executor::bindNative(Function &function, const NativeFunction &native) {
+  if (!function.isDeclaration())
+    throw std::runtime_error("cannot bind a native function to " + function.name() + ", which already has a body");
+  auto functionType = mystl::staticCast<const FunctionType>(function.type());
+  if (!native.matches(*functionType))
+    throw std::runtime_error("native function signature does not match the declaration of " + function.name());
+  m_nativeFunctions.insert_or_assign(cref(function), native);
+  return *this;
+}
+
+}
@@ -1,12 +1,69 @@
 //
 // Created by creeper on 11/3/24.
 //
+#include <utility>
 #include <chiisai-llvm/function.h>
 #include <chiisai-llvm/executor.h>
+#include <chiisai-llvm/llvm-context.h>
 
 namespace llvm {
 
-void Function::accept(Executor &executor) {
+BasicBlock &Function::addBasicBlock(const std::string &name) {
+  auto &basicBlock = basicBlocks.emplace_back(type()->context().symbols().intern(name), m_arena);
+  basicBlock.m_function = ref(*this);
+  basicBlock.m_index = m_blockIndexBound++;
+  m_revision++;
+  return basicBlock;
+}
+
+void Function::materialize() {
+  if (!m_materializer)
+    return;
+  // a materializer that fails drops what it built, so the body can be built from scratch again
+  m_materializer->materialize(*this);
+  m_materializer = nullptr;
+}
+
+void Function::dropBody() {
+  // releasing the instructions one by one also unbinds their names and the edges between the blocks
+  for (auto &basicBlock : basicBlocks)
+    while (!basicBlock.instructions.empty())
+      basicBlock.release(*basicBlock.instructions.back());
+  basicBlocks.clear();
+  m_localVars.clear();
+  m_localVarMap.clear();
+  renumber();
+}
 
+void Function::renumber() {
+  m_valueIndexBound = 0;
+  m_blockIndexBound = 0;
+  for (auto argument : m_args)
+    argument->m_localIndex = m_valueIndexBound++;
+  for (auto &basicBlock : basicBlocks) {
+    basicBlock.m_index = m_blockIndexBound++;
+    for (auto inst : basicBlock.instructions)
+      inst->m_localIndex = m_valueIndexBound++;
+  }
+  m_numberingCanonical = true;
+  m_revision++;
+}
+
+Ref<Value> Function::lookup(std::string_view name) const {
+  if (auto argument = arg(name))
+    return argument;
+  auto it = m_localResults.find(name);
+  return it == m_localResults.end() ? nullptr : it->second;
+}
+
+void Function::accept(Executor &executor) {
+  if (isDeclaration())
+    throw std::runtime_error("cannot execute function " + name() + ", which has no body");
+  // terminators only record the next block, so control flow never deepens the native stack
+  Ref<BasicBlock> current = ref(basicBlocks.front());
+  while (current) {
+    executor.execute(current);
+    current = executor.takeNextBasicBlock(*current);
+  }
 }
 }
\ No newline at end of file
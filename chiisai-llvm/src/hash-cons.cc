@@ -0,0 +1,40 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <chiisai-llvm/hash-cons.h>
+#include <chiisai-llvm/instruction.h>
+
+namespace llvm {
+
+Ref<Instruction> HashConsTable::find(const Instruction &inst) const {
+  auto [begin, end] = m_instructions.equal_range(inst.hash());
+  for (auto it = begin; it != end; ++it)
+    if (it->second.get() != &inst && it->second->isIdenticalTo(inst))
+      return it->second;
+  return nullptr;
+}
+
+Ref<Instruction> HashConsTable::insert(Instruction &inst) {
+  if (!inst.isHashConsable() || inst.m_hashConsed)
+    return ref(inst);
+  if (auto existing = find(inst))
+    return existing;
+  m_instructions.emplace(inst.hash(), ref(inst));
+  inst.m_hashConsed = true;
+  return ref(inst);
+}
+
+void HashConsTable::erase(Instruction &inst) {
+  if (!inst.m_hashConsed)
+    return;
+  // the key is the hash the instruction was added with, which stays cached until the instruction leaves
+  auto [begin, end] = m_instructions.equal_range(inst.hash());
+  for (auto it = begin; it != end; ++it)
+    if (it->second.get() == &inst) {
+      m_instructions.erase(it);
+      break;
+    }
+  inst.m_hashConsed = false;
+}
+
+}
@@ -1,6 +1,7 @@
 //
 // Created by creeper on 11/3/24.
 //
+#include <algorithm>
 #include <functional>
 #include <chiisai-llvm/instruction.h>
 #include <chiisai-llvm/executor.h>
@@ -9,9 +10,47 @@
 #include <chiisai-llvm/basic-block.h>
 namespace llvm {
 
+void Instruction::addOperand(Ref<Value> &slot) {
+  addUse(ref(*this), slot, function().arena());
+}
+
+uint64_t Instruction::hash() const {
+  if (m_hash)
+    return m_hash;
+  size_t hashCode{};
+  mystl::hash_combine(hashCode, opCode);
+  mystl::hash_combine(hashCode, type()->id());
+  for (auto operand : usedValues())
+    mystl::hash_combine(hashCode, operand.get());
+  hashAttributes(hashCode);
+  // 0 marks the hash as not computed yet
+  m_hash = hashCode ? hashCode : 1;
+  return m_hash;
+}
+
+bool Instruction::isIdenticalTo(const Instruction &other) const {
+  if (opCode != other.opCode || type() != other.type() || hash() != other.hash())
+    return false;
+  auto operands = usedValues(), otherOperands = other.usedValues();
+  if (!std::ranges::equal(operands, otherOperands))
+    return false;
+  return sameAttributes(other);
+}
+
+void Instruction::operandChanged() {
+  if (m_hashConsed)
+    function().hashCons().erase(*this);
+  m_hash = 0;
+}
+
+Instruction::~Instruction() {
+  if (m_hashConsed)
+    function().hashCons().erase(*this);
+}
+
 void BinaryInst::accept(Executor &executor) {
-  const auto &lhsReg = executor.reg(lhs->name());
-  const auto &rhsReg = executor.reg(rhs->name());
+  const auto &lhsReg = executor.reg(*lhs);
+  const auto &rhsReg = executor.reg(*rhs);
   if (!lhsReg.canOperateWith(rhsReg))
     throw std::runtime_error("Binary instruction operands must have the same type and cannot be an address or a boolean");
 
@@ -74,43 +113,49 @@ void BinaryInst::accept(Executor &executor) {
   };
 
   if (isIntBinary())
-    executor.reg(name()) = Result{intOps[static_cast<BinaryOps>(opCode)](lhsReg.toInteger(), rhsReg.toInteger())};
+    executor.setReg(*this, Result{intOps[static_cast<BinaryOps>(opCode)](lhsReg.toInteger(), rhsReg.toInteger())});
   else if (isFloatBinary())
-    executor.reg(name()) = Result{floatOps[static_cast<BinaryOps>(opCode)](lhsReg.toFloating(), rhsReg.toFloating())};
+    executor.setReg(*this, Result{floatOps[static_cast<BinaryOps>(opCode)](lhsReg.toFloating(), rhsReg.toFloating())});
   else
     throw std::runtime_error("What the fucking binary instruction is this?");
 }
 
-void StoreInst::accept(Executor &executor) {
-  auto src = executor.reg(pointer->name());
-  if (src.isPointer())
-    throw std::runtime_error("Store instruction cannot store a pointer");
+void AllocaInst::accept(Executor &executor) {
+  executor.setReg(*this, Result{executor.allocate(*type(), size())});
+}
 
-  auto srcPointer = std::get<Address>(src.value);
+void StoreInst::accept(Executor &executor) {
+  const auto &dest = executor.reg(*pointer);
+  if (!dest.isPointer())
+    throw std::runtime_error("Store instruction must store to a pointer");
+  executor.store(dest.toPointer(), executor.reg(*value));
 }
 
 void LoadInst::accept(Executor &executor) {
-  executor.reg(name()) = executor.reg(pointer->name());
+  const auto &src = executor.reg(*pointer);
+  if (!src.isPointer())
+    throw std::runtime_error("Load instruction must load from a pointer");
+  executor.setReg(*this, executor.load(src.toPointer()));
 }
 
 void CallInst::accept(Executor &executor) {
-  auto func = executor.module.function(function.name());
-  executor.pushFrame();
-  for (auto arg : func->args()) {
-    executor.reg(arg->name()) = executor.reg(arg->name());
+  if (auto native = executor.nativeFunction(function)) {
+    if (m_realArgs.size() != native->arity)
+      throw std::runtime_error("wrong number of arguments passed to native function " + function.name());
+    NativeFunction::Args args{};
+    for (size_t i = 0; i < m_realArgs.size(); i++)
+      args[i] = &executor.reg(*m_realArgs[i]);
+    if (auto ret = native->call(args))
+      executor.setReg(*this, *ret);
+    return;
   }
-  executor.execute(func);
-  executor.popFrame();
-}
-
-uint64_t CallInst::hash() const {
-  uint64_t hashCode;
-  mystl::hash_combine(hashCode, name());
-  mystl::hash_combine(hashCode, opCode);
-  mystl::hash_combine(hashCode, function.name());
-  for (const auto &arg : realArgs)
-    mystl::hash_combine(hashCode, arg);
-  return hashCode;
+  // arguments must be read from the caller's frame before the callee's frame is pushed
+  std::vector<Result> argValues{};
+  argValues.reserve(m_realArgs.size());
+  for (const auto &arg : m_realArgs)
+    argValues.push_back(executor.reg(*arg));
+  if (auto ret = executor.call(function, argValues))
+    executor.setReg(*this, *ret);
 }
 
 void CmpInst::accept(Executor &executor) {
@@ -153,41 +198,55 @@ void CmpInst::accept(Executor &executor) {
        [](Result::Floating lhs, Result::Floating rhs) { return std::visit(std::less_equal<>(), lhs, rhs); }},
   };
 
-  const auto &lhsReg = executor.reg(lhs->name());
-  const auto &rhsReg = executor.reg(rhs->name());
+  const auto &lhsReg = executor.reg(*lhs);
+  const auto &rhsReg = executor.reg(*rhs);
 
   if (!lhsReg.canOperateWith(rhsReg))
     throw std::runtime_error("Binary instruction operands must have the same type and cannot be an address or a boolean");
 
-  if (isIntBinary())
-    executor.reg(name()) = Result{intPredicates[predicate](lhsReg.toInteger(), rhsReg.toInteger())};
-  else if (isFloatBinary())
-    executor.reg(name()) = Result{floatPredicates[predicate](lhsReg.toFloating(), rhsReg.toFloating())};
+  if (opCode == OtherOps::ICmp)
+    executor.setReg(*this, Result{intPredicates[m_predicate](lhsReg.toInteger(), rhsReg.toInteger())});
+  else if (opCode == OtherOps::FCmp)
+    executor.setReg(*this, Result{floatPredicates[m_predicate](lhsReg.toFloating(), rhsReg.toFloating())});
   else
     throw std::runtime_error("What the fucking comparison instruction is this?");
 }
 
 void PhiInst::accept(Executor &executor) {
   const auto &incoming = executor.incomingBasicBlock;
-  for (const auto &[bb, value] : incomingValues)
-    if (bb->name() == incoming) {
-      executor.reg(name()) = executor.reg(value->name());
+  for (const auto &[bb, value] : m_incomingValues)
+    if (bb->symbol() == incoming) {
+      executor.setReg(*this, executor.reg(*value));
       return;
     }
 }
 
+void RetInst::accept(Executor &executor) {
+  if (value)
+    executor.ret(executor.reg(*value));
+  else
+    executor.ret(std::nullopt);
+}
+
+void BrInst::setSuccessor(size_t index, BasicBlock &dest) {
+  auto &target = index == 1 && isConditional() ? m_elseBranch : m_thenBranch;
+  if (successor(index) == ref(dest))
+    return;
+  basicBlock().replaceSuccessor(index, dest);
+  target = ref(dest);
+  operandChanged();
+}
+
 void BrInst::accept(Executor &executor) {
-  if (isConditional()) {
-    if (executor.reg(cond().name()).isBool()) {
-      if (std::get<bool>(executor.reg(cond().name()).value))
-        executor.execute(thenBranch());
-      else
-        executor.execute(elseBranch());
-    } else
-      throw std::runtime_error("Branch condition must be a boolean");
-  } else
-    executor.execute(std::get<CRef<BasicBlock>>(dest));
-  executor.incomingBasicBlock = basicBlock.name();
+  executor.incomingBasicBlock = basicBlock().symbol();
+  if (!isConditional()) {
+    executor.jump(m_thenBranch);
+    return;
+  }
+  const auto &condReg = executor.reg(*m_cond);
+  if (!condReg.isBool())
+    throw std::runtime_error("Branch condition must be a boolean");
+  executor.jump(std::get<bool>(condReg.value) ? m_thenBranch : m_elseBranch);
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,154 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <cstdio>
+#include <algorithm>
+#include <stdexcept>
+#include <chiisai-llvm/ir-mem-stats.h>
+#include <chiisai-llvm/module.h>
+#include <chiisai-llvm/function.h>
+#include <chiisai-llvm/instruction.h>
+#include <chiisai-llvm/mystl/castings.h>
+
+namespace llvm {
+
+namespace {
+
+template<typename Vector>
+size_t spilledBytes(const Vector &vector) {
+  return vector.is_inline() ? 0 : vector.capacity() * sizeof(*vector.data());
+}
+
+size_t operandCount(const Instruction &inst) {
+  size_t count = 0;
+  for ([[maybe_unused]] auto &use : inst.operands())
+    count++;
+  return count;
+}
+
+}
+
+IRMemStats::Footprint &IRMemStats::Footprint::operator+=(const Footprint &other) {
+  count += other.count;
+  objectBytes += other.objectBytes;
+  useBytes += other.useBytes;
+  spillBytes += other.spillBytes;
+  return *this;
+}
+
+IRMemStats::OpClass IRMemStats::opClass(uint8_t opCode) {
+  if (opCode < Instruction::TerminatorIDEnd)
+    return OpClass::Terminator;
+  if (opCode < Instruction::BinaryIDEnd)
+    return OpClass::Binary;
+  if (opCode < Instruction::LogicalIDEnd)
+    return OpClass::Logical;
+  if (opCode < Instruction::MemoryIDEnd)
+    return OpClass::Memory;
+  return OpClass::Other;
+}
+
+std::string_view IRMemStats::opClassName(OpClass opClass) {
+  switch (opClass) {
+  case OpClass::Terminator: return "terminator";
+  case OpClass::Binary: return "binary";
+  case OpClass::Logical: return "logical";
+  case OpClass::Memory: return "memory";
+  case OpClass::Other: return "other";
+  }
+  throw std::runtime_error("unknown opcode class");
+}
+
+size_t IRMemStats::objectSize(uint8_t opCode) {
+  switch (opCode) {
+  case Instruction::Ret: return sizeof(RetInst);
+  case Instruction::Br: return sizeof(BrInst);
+  case Instruction::Alloca: return sizeof(AllocaInst);
+  case Instruction::Load: return sizeof(LoadInst);
+  case Instruction::Store: return sizeof(StoreInst);
+  case Instruction::Gep: return sizeof(GepInst);
+  case Instruction::Phi: return sizeof(PhiInst);
+  case Instruction::Call: return sizeof(CallInst);
+  case Instruction::ICmp: case Instruction::FCmp: return sizeof(CmpInst);
+  default:
+    if (opCode < Instruction::LogicalIDEnd)
+      return sizeof(BinaryInst);
+    throw std::runtime_error("unknown opcode " + std::to_string(opCode));
+  }
+}
+
+IRMemStats IRMemStats::of(const Module &module) {
+  IRMemStats stats{};
+  for (auto function : module.functions)
+    stats.add(*function);
+  return stats;
+}
+
+void IRMemStats::add(const Function &function) {
+  functionCount++;
+  // the body of a lazy function is still in the file it is loaded from
+  if (!function.isMaterialized()) {
+    lazyFunctionCount++;
+    return;
+  }
+  for (const auto &basicBlock : function.basicBlocks) {
+    basicBlockCount++;
+    // a node of std::list holds the block after the two links
+    basicBlockBytes += sizeof(BasicBlock) + 2 * sizeof(void *);
+    basicBlock.forEachInstruction([this](Ref<Instruction> inst) {
+      add(*inst);
+    });
+  }
+  arenaBytes += function.arena().bytes_allocated;
+  arenaSlabCount += function.arena().slab_count();
+}
+
+void IRMemStats::add(const Instruction &inst) {
+  auto &footprint = m_classes[static_cast<size_t>(opClass(inst.opCode))];
+  footprint.count++;
+  footprint.objectBytes += objectSize(inst.opCode);
+  footprint.useBytes += operandCount(inst) * sizeof(Use);
+  if (auto phi = mystl::dyn_cast<PhiInst>(&inst))
+    footprint.spillBytes += spilledBytes(phi->incomingValues());
+  else if (auto call = mystl::dyn_cast<CallInst>(&inst))
+    footprint.spillBytes += spilledBytes(call->realArgs());
+  else if (auto gep = mystl::dyn_cast<GepInst>(&inst))
+    footprint.spillBytes += spilledBytes(gep->indices());
+}
+
+IRMemStats::Footprint IRMemStats::total() const {
+  Footprint total{};
+  for (const auto &footprint : m_classes)
+    total += footprint;
+  return total;
+}
+
+std::string IRMemStats::str() const {
+  std::string out{};
+  char line[256];
+  auto append = [&out, &line](int length) {
+    out.append(line, std::min(static_cast<size_t>(length), sizeof(line) - 1));
+  };
+  auto row = [&](std::string_view name, const Footprint &footprint) {
+    auto perInst = footprint.count ? static_cast<double>(footprint.bytes()) / static_cast<double>(footprint.count) : 0.0;
+    append(std::snprintf(line, sizeof(line), "%-12.*s%10zu%12zu%12zu%10zu%12zu%10.1f\n",
+                         static_cast<int>(name.size()), name.data(), footprint.count, footprint.objectBytes,
+                         footprint.useBytes, footprint.spillBytes, footprint.bytes(), perInst));
+  };
+  append(std::snprintf(line, sizeof(line), "%-12s%10s%12s%12s%10s%12s%10s\n",
+                       "class", "count", "object", "uses", "spill", "bytes", "per inst"));
+  for (size_t i = 0; i < OpClassCount; i++) {
+    auto opClass = static_cast<OpClass>(i);
+    row(opClassName(opClass), (*this)[opClass]);
+  }
+  auto instructions = total();
+  row("total", instructions);
+  append(std::snprintf(line, sizeof(line),
+                       "module: %zu functions (%zu not materialized), %zu blocks in %zu bytes, "
+                       "%zu instructions in %zu bytes, %zu arena bytes in %zu slabs\n",
+                       functionCount, lazyFunctionCount, basicBlockCount, basicBlockBytes, instructions.count,
+                       instructions.bytes(), arenaBytes, arenaSlabCount));
+  return out;
+}
+
+}
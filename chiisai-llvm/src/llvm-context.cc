@@ -6,39 +6,64 @@
 #include <chiisai-llvm/instruction.h>
 #include <chiisai-llvm/type-system.h>
 #include <chiisai-llvm/constant-pool.h>
+#include <chiisai-llvm/mystl/flat_hash_map.h>
 namespace llvm {
 
-uint8_t stoinst(const std::string &str) {
-  static std::unordered_map<std::string, uint8_t> map{
-      {"add", Instruction::Add},
-      {"fadd", Instruction::FAdd},
-      {"sub", Instruction::Sub},
-      {"fsub", Instruction::FSub},
-      {"mul", Instruction::Mul},
-      {"fmul", Instruction::FMul},
-      {"sdiv", Instruction::SDiv},
-      {"fdiv", Instruction::FDiv},
-      {"srem", Instruction::SRem},
-      {"xor", Instruction::Xor},
-      {"shl", Instruction::Shl},
-      {"lshr", Instruction::LShr},
-      {"ashr", Instruction::AShr},
-      {"and", Instruction::And},
-      {"or", Instruction::Or},
-      {"alloca", Instruction::Alloca},
-      {"load", Instruction::Load},
-      {"store", Instruction::Store},
-      {"ret", Instruction::Ret},
-      {"br", Instruction::Br},
-      {"call", Instruction::Call},
-  };
-  return map[str];
-}
-
-LLVMContext::LLVMContext() : typeSystem(std::make_unique<TypeSystem>()) {}
+uint8_t stoinst(std::string_view str) {
+  // only read once built, so concurrent parsers can share it
+  static const mystl::flat_hash_map<std::string_view, uint8_t> map = [] {
+    mystl::flat_hash_map<std::string_view, uint8_t> ops{};
+    for (auto [name, op] : std::initializer_list<std::pair<std::string_view, uint8_t>>{
+        {"add", Instruction::Add},
+        {"fadd", Instruction::FAdd},
+        {"sub", Instruction::Sub},
+        {"fsub", Instruction::FSub},
+        {"mul", Instruction::Mul},
+        {"fmul", Instruction::FMul},
+        {"sdiv", Instruction::SDiv},
+        {"fdiv", Instruction::FDiv},
+        // the division of the grammar, signed unless resolved by the operand type
+        {"div", Instruction::SDiv},
+        {"srem", Instruction::SRem},
+        {"xor", Instruction::Xor},
+        {"shl", Instruction::Shl},
+        {"lshr", Instruction::LShr},
+        {"ashr", Instruction::AShr},
+        {"and", Instruction::And},
+        {"or", Instruction::Or},
+        {"alloca", Instruction::Alloca},
+        {"load", Instruction::Load},
+        {"store", Instruction::Store},
+        {"getelementptr", Instruction::Gep},
+        {"phi", Instruction::Phi},
+        {"icmp", Instruction::ICmp},
+        {"fcmp", Instruction::FCmp},
+        {"ret", Instruction::Ret},
+        {"br", Instruction::Br},
+        {"call", Instruction::Call},
+    })
+      ops[name] = op;
+    return ops;
+  }();
+  auto it = map.find(str);
+  if (it == map.end())
+    throw std::runtime_error("unknown instruction " + std::string(str));
+  return it->second;
+}
+
+uint8_t stoinst(std::string_view str, const Type &operandType) {
+  auto op = stoinst(str);
+  if (str == "div" && operandType.isFloatingPoint())
+    return Instruction::FDiv;
+  return op;
+}
+
+LLVMContext::LLVMContext()
+    : symbolTable(std::make_unique<SymbolTable>()), typeSystem(std::make_unique<TypeSystem>(*this)),
+      constantPool(std::make_unique<ConstantPool>()) {}
 LLVMContext::~LLVMContext() = default;
 
-CRef<Type> LLVMContext::stobt(const std::string &str) const {
+CRef<Type> LLVMContext::stobt(std::string_view str) const {
   return typeSystem->stobt(str);
 }
 
@@ -78,8 +103,24 @@ CRef<IntegerType> LLVMContext::longType() const {
   return cref(typeSystem->longInstance);
 }
 
-Ref<Constant> LLVMContext::constant(CRef<Type> type, const std::string &str) {
-  return constantPool->constant(type, str);
+CRef<Type> LLVMContext::type(uint32_t id) const {
+  return typeSystem->type(id);
+}
+
+Ref<Constant> LLVMContext::constant(CRef<Type> type, std::string_view literal) {
+  return constantPool->scalar(type, literal);
+}
+
+Ref<ConstantScalar> LLVMContext::intConstant(CRef<Type> type, int64_t value) {
+  return constantPool->integer(type, value);
+}
+
+Ref<ConstantScalar> LLVMContext::floatConstant(CRef<Type> type, double value) {
+  return constantPool->floating(type, value);
+}
+
+Ref<ConstantArray> LLVMContext::constantArray(CRef<ArrayType> type, std::span<const CRef<Constant>> elements) {
+  return constantPool->array(type, elements);
 }
 
 }  // namespace llvm
@@ -0,0 +1,39 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <algorithm>
+#include <chiisai-llvm/mapped-char-stream.h>
+
+namespace llvm {
+
+std::string_view MappedCharStream::view(const antlr4::misc::Interval &interval) const {
+  auto text = m_file.text();
+  if (interval.a < 0 || interval.b < interval.a || static_cast<size_t>(interval.a) >= text.size())
+    return {};
+  auto start = static_cast<size_t>(interval.a);
+  auto stop = std::min(static_cast<size_t>(interval.b), text.size() - 1);
+  return text.substr(start, stop - start + 1);
+}
+
+void MappedCharStream::consume() {
+  if (m_position >= m_file.size())
+    throw antlr4::IllegalStateException("cannot consume EOF");
+  m_position++;
+}
+
+size_t MappedCharStream::LA(ssize_t i) {
+  // LA(0) is undefined, LA(1) is the next character and LA(-1) the one consumed last
+  if (i == 0)
+    return 0;
+  auto offset = i > 0 ? static_cast<ssize_t>(m_position) + i - 1 : static_cast<ssize_t>(m_position) + i;
+  if (offset < 0 || static_cast<size_t>(offset) >= m_file.size())
+    return antlr4::IntStream::EOF;
+  return static_cast<unsigned char>(m_file.data()[offset]);
+}
+
+void MappedCharStream::seek(size_t index) {
+  // every character is one byte, so there is nothing to consume on the way
+  m_position = std::min(index, m_file.size());
+}
+
+}
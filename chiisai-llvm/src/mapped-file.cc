@@ -0,0 +1,56 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <chiisai-llvm/mapped-file.h>
+#if defined(__unix__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace llvm {
+
+MappedFile::MappedFile(const std::filesystem::path &path) {
+#if defined(__unix__)
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("failed to open file " + path.string());
+  struct stat status{};
+  if (fstat(fd, &status) != 0) {
+    close(fd);
+    throw std::runtime_error("failed to stat file " + path.string());
+  }
+  // mmap rejects an empty length, and there is nothing to map anyway
+  if (status.st_size > 0) {
+    m_size = static_cast<size_t>(status.st_size);
+    m_mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (m_mapping == MAP_FAILED) {
+    m_mapping = nullptr;
+    throw std::runtime_error("failed to map file " + path.string());
+  }
+  if (m_mapping)
+    m_data = static_cast<const char *>(m_mapping);
+#else
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    throw std::runtime_error("failed to open file " + path.string());
+  m_buffer.assign(std::istreambuf_iterator<char>(file), {});
+  m_data = m_buffer.data();
+  m_size = m_buffer.size();
+#endif
+}
+
+MappedFile::~MappedFile() {
+#if defined(__unix__)
+  if (m_mapping)
+    munmap(m_mapping, m_size);
+#endif
+}
+
+}
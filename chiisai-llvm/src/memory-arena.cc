@@ -0,0 +1,99 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <new>
+#include <algorithm>
+#include <cstdlib>
+#include <chiisai-llvm/memory-arena.h>
+#include <minilog/logger.h>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace llvm {
+
+static size_t alignUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+MemoryArena::~MemoryArena() {
+  for (const auto &region : m_regions) {
+    if (region.backing == Backing::Heap) {
+      std::free(region.base);
+      continue;
+    }
+#if defined(__linux__)
+    munmap(region.base, region.size);
+#endif
+  }
+}
+
+MemoryArena::Region MemoryArena::reserve(size_t bytes) {
+  auto size = alignUp(std::max(bytes, m_options.regionSize), HugePageSize);
+#if defined(__linux__)
+  bool wantsHugePages = size >= HugePageSize;
+  if (wantsHugePages && m_options.explicitHugePages) {
+    void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (base != MAP_FAILED)
+      return {.base = static_cast<std::byte *>(base), .size = size, .backing = Backing::HugeTlb};
+  }
+  void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (base != MAP_FAILED) {
+    if (wantsHugePages && m_options.transparentHugePages && madvise(base, size, MADV_HUGEPAGE) == 0)
+      return {.base = static_cast<std::byte *>(base), .size = size, .backing = Backing::TransparentHugePages};
+    return {.base = static_cast<std::byte *>(base), .size = size, .backing = Backing::Pages};
+  }
+  minilog::warn("failed to map {} bytes for the executor, falling back to the heap", size);
+#endif
+  auto heap = static_cast<std::byte *>(std::aligned_alloc(HugePageSize, size));
+  if (!heap)
+    throw std::bad_alloc();
+  return {.base = heap, .size = size, .backing = Backing::Heap};
+}
+
+void *MemoryArena::allocate(size_t bytes, size_t alignment) {
+  auto fits = [bytes, alignment](const Region &region) {
+    return alignUp(region.offset, alignment) + bytes <= region.size;
+  };
+  if (m_regions.empty() || !fits(m_regions[m_current])) {
+    // regions after the current one are empty, reuse the next one if it is large enough
+    size_t next = m_regions.empty() ? 0 : m_current + 1;
+    if (next == m_regions.size() || !fits(m_regions[next])) {
+      auto region = reserve(bytes + alignment);
+      m_stats.reservedBytes += region.size;
+      m_stats.regions++;
+      if (region.backing == Backing::HugeTlb)
+        m_stats.hugeTlbRegions++;
+      else if (region.backing == Backing::TransparentHugePages)
+        m_stats.transparentHugePageRegions++;
+      else if (region.backing == Backing::Heap)
+        m_stats.heapRegions++;
+      if (region.backing == Backing::HugeTlb || region.backing == Backing::TransparentHugePages)
+        m_stats.hugePageBytes += region.size;
+      m_regions.insert(m_regions.begin() + static_cast<ptrdiff_t>(next), region);
+    }
+    m_current = next;
+  }
+  auto &region = m_regions[m_current];
+  auto begin = alignUp(region.offset, alignment);
+  m_stats.usedBytes += begin + bytes - region.offset;
+  m_stats.peakUsedBytes = std::max(m_stats.peakUsedBytes, m_stats.usedBytes);
+  m_stats.allocations++;
+  region.offset = begin + bytes;
+  return region.base + begin;
+}
+
+void MemoryArena::release(Marker marker) {
+  if (m_regions.empty())
+    return;
+  for (size_t i = m_current; i > marker.region; i--) {
+    m_stats.usedBytes -= m_regions[i].offset;
+    m_regions[i].offset = 0;
+  }
+  auto &region = m_regions[marker.region];
+  m_stats.usedBytes -= region.offset - marker.offset;
+  region.offset = marker.offset;
+  m_current = marker.region;
+}
+
+}
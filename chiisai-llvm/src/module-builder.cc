@@ -13,6 +13,44 @@ namespace llvm {
 std::any llvm::ModuleBuilder::visitModule(LLVMParser::ModuleContext *ctx) {
   llvmContext = std::make_unique<LLVMContext>();
   module = std::make_unique<Module>();
+  for (auto globalDeclaration : ctx->globalDeclaration())
+    visitGlobalDeclaration(globalDeclaration);
+  // every function is declared before any body is built, so that a body can call a function defined later
+  for (auto functionDefinition : ctx->functionDefinition())
+    declareFunction(functionDefinition);
+  for (auto functionDefinition : ctx->functionDefinition())
+    visitFunctionDefinition(functionDefinition);
+  return {};
+}
+
+std::any ModuleBuilder::visitGlobalDeclaration(LLVMParser::GlobalDeclarationContext *ctx) {
+  visitType(ctx->type());
+  auto varType = ctx->type()->typeRef;
+  std::string name = variableName(ctx->globalIdentifier());
+  if (module->hasGlobalVar(name) || module->hasFunction(name))
+    throw std::runtime_error("Global variable name already exists in the module");
+  CRef<Constant> initializer{};
+  if (auto init = ctx->initializer(); init && init->constantArray()) {
+    auto array = init->constantArray();
+    visitType(array->type());
+    auto arrayType = llvmContext->arrayType(array->type()->typeRef, std::stoul(array->IntegerLiteral()->getText()));
+    std::vector<CRef<Constant>> elements;
+    elements.reserve(array->value().size());
+    for (auto value : array->value()) {
+      auto element = mystl::dyn_cast<Constant>(resolveValueUsage(value));
+      if (!element)
+        throw std::runtime_error("the elements of constant array " + name + " must be constants");
+      elements.emplace_back(element);
+    }
+    array->constArray = llvmContext->constantArray(arrayType, elements);
+    initializer = array->constArray;
+  } else if (init)
+    initializer = llvmContext->constant(varType, init->getText());
+  module->addGlobalVariable(std::make_unique<GlobalVariable>(GlobalVariableDetails{
+      .name = name,
+      .type = varType,
+      .initializer = initializer,
+  }));
   return {};
 }
 
@@ -35,33 +73,74 @@ std::any ModuleBuilder::visitArrayType(LLVMParser::ArrayTypeContext *ctx) {
 }
 
 std::any ModuleBuilder::visitPointerType(LLVMParser::PointerTypeContext *ctx) {
-  auto elementTypeNode = ctx->basicType();
-  visitBasicType(elementTypeNode);
-  auto elementType = elementTypeNode->typeRef;
+  CRef<Type> elementType{};
+  if (auto basicTy = ctx->basicType()) {
+    visitBasicType(basicTy);
+    elementType = basicTy->typeRef;
+  } else if (auto arrayTy = ctx->arrayType()) {
+    visitArrayType(arrayTy);
+    elementType = arrayTy->typeRef;
+  } else {
+    visitPointerType(ctx->pointerType());
+    elementType = ctx->pointerType()->typeRef;
+  }
   if (elementType == Type::voidType(*llvmContext)) {
     // ERROR
   }
-  ctx->typeRef = llvmContext->pointerType(elementType);
+  // every asterisk is one more level of indirection
+  for (size_t i = 0; i < ctx->Asterisk().size(); i++)
+    elementType = llvmContext->pointerType(elementType);
+  ctx->typeRef = elementType;
   return {};
 }
 
-Ref<Value> ModuleBuilder::resolveValueUsage(LLVMParser::ValueContext *ctx) {
+Ref<Value> ModuleBuilder::resolveValueUsage(LLVMParser::ValueContext *ctx, CRef<Type> type) {
   visitValue(ctx);
-  auto var = ctx->variable();
   if (ctx->number()) {
-    auto type = llvmContext->stobt(ctx->number()->scalarType()->getText());
+    auto numberType = llvmContext->stobt(ctx->number()->scalarType()->getText());
     const auto &str = ctx->number()->literal()->getText();
-    return llvmContext->constant(type, str);
-  } else if (ctx->isGlobal)
-    return module->globalVariable(var->name);
+    return llvmContext->constant(numberType, str);
+  }
+  return resolveVariableUsage(ctx->variable(), type);
+}
 
-  if (auto arg = currentFunction->arg(var->name))
-    return arg;
+Ref<Value> ModuleBuilder::resolveVariableUsage(LLVMParser::VariableContext *ctx, CRef<Type> type) {
+  visitVariable(ctx);
+  if (ctx->isGlobal)
+    return module->globalVariable(ctx->name);
+  // e.g. an element of the initializer of a global variable
+  if (!currentFunction)
+    throw std::runtime_error("local " + ctx->name + " is used outside of a function");
 
-  if (auto localVar = currentFunction->localVar(var->name))
-    return localVar;
+  if (auto local = currentFunction->lookup(ctx->name))
+    return local;
+  if (auto it = forwardRefs.find(ctx->name); it != forwardRefs.end())
+    return ref<Value>(*it->second);
+  if (!type)
+    throw std::runtime_error("cannot find symbol " + ctx->name);
+  return ref<Value>(*forwardRefs.try_emplace(ctx->name, std::make_unique<Argument>("", type)).first->second);
+}
+
+Ref<BasicBlock> ModuleBuilder::resolveBasicBlock(LLVMParser::LocalVariableContext *ctx) const {
+  auto name = ctx->getText().substr(1);
+  auto it = basicBlocks.find(name);
+  if (it == basicBlocks.end())
+    throw std::runtime_error("cannot find basic block " + name);
+  return it->second;
+}
 
-  // ERROR: cannot find the symbol
+// a local used before its definition is bound to it once the instruction defining it is built
+void ModuleBuilder::bindForwardRef() {
+  if (forwardRefs.empty() || currentBasicBlock->instructions.empty())
+    return;
+  auto inst = currentBasicBlock->instructions.back();
+  auto it = forwardRefs.find(inst->name());
+  if (it == forwardRefs.end())
+    return;
+  if (it->second->type() != inst->type())
+    throw std::runtime_error(inst->name() + " is used with another type than it is defined with");
+  it->second->replaceAllUsesWith(inst);
+  forwardRefs.erase(it);
 }
 
 static std::vector<CRef<Type>> formContainedTypes(CRef<Type> returnType, std::vector<CRef<Type>> &&argTypes) {
@@ -72,7 +151,7 @@ static std::vector<CRef<Type>> formContainedTypes(CRef<Type> returnType, std::ve
   return containedTypes;
 }
 
-std::any ModuleBuilder::visitFunctionDefinition(LLVMParser::FunctionDefinitionContext *ctx) {
+void ModuleBuilder::declareFunction(LLVMParser::FunctionDefinitionContext *ctx) {
   auto returnTypeCtx = ctx->type();
   auto funcName = ctx->globalIdentifier()->NamedIdentifier()->getText();
 
@@ -87,20 +166,32 @@ std::any ModuleBuilder::visitFunctionDefinition(LLVMParser::FunctionDefinitionCo
   visitFunctionArguments(args);
   // append argTypes and returnTypes together to form containedTypes
   std::vector<CRef<Type>> containedTypes = formContainedTypes(returnType, std::move(args->argTypes));
-  auto functionType = llvmContext->functionType(containedTypes);
-  const auto &basicBlocks = ctx->basicBlock();
   module->addFunction(std::make_unique<Function>(FunctionInfo{.name = funcName,
       .functionType = llvmContext->functionType(containedTypes),
       .argNames = std::move(args->argNames),
       .module = *module}));
-  std::list<BasicBlock> basicBlocksList{};
-  for (auto bb : basicBlocks)
+}
+
+std::any ModuleBuilder::visitFunctionDefinition(LLVMParser::FunctionDefinitionContext *ctx) {
+  currentFunction = module->function(ctx->globalIdentifier()->NamedIdentifier()->getText());
+  // blocks are created up front, so that branches and phis can refer to the blocks that follow
+  for (auto bb : ctx->basicBlock()) {
+    auto name = bb->NamedIdentifier()->getText();
+    if (!basicBlocks.try_emplace(name, ref(currentFunction->addBasicBlock(name))).second)
+      throw std::runtime_error("basic block " + name + " is defined more than once");
+  }
+  for (auto bb : ctx->basicBlock())
     visitBasicBlock(bb);
+  if (!forwardRefs.empty())
+    throw std::runtime_error("cannot find symbol " + forwardRefs.begin()->first);
+  basicBlocks.clear();
+  currentFunction = nullptr;
+  currentBasicBlock = nullptr;
   return {};
 }
 
 std::any ModuleBuilder::visitBasicBlock(LLVMParser::BasicBlockContext *ctx) {
-  ctx->basicBlockInstance = std::make_unique<BasicBlock>(ctx->Label()->getText());
+  currentBasicBlock = basicBlocks.at(ctx->NamedIdentifier()->getText());
   const auto &instructions = ctx->instruction();
   for (auto inst : instructions)
     visitInstruction(inst);
@@ -133,13 +224,14 @@ std::any ModuleBuilder::visitArithmeticInstruction(LLVMParser::ArithmeticInstruc
 
   if (operands.size() != 2)
     throw std::runtime_error("Arithmetic instruction must have exactly two operands");
-  auto operandLeftRef = resolveValueUsage(operands[0]);
-  auto operandRightRef = resolveValueUsage(operands[1]);
+  visitType(ctx->type());
+  auto operandLeftRef = resolveValueUsage(operands[0], ctx->type()->typeRef);
+  auto operandRightRef = resolveValueUsage(operands[1], ctx->type()->typeRef);
 
   if (!Instruction::checkBinaryInstType(operandLeftRef, operandRightRef))
     throw std::runtime_error("Binary instruction operands must have the same type");
 
-  auto opcode = stoinst(ctx->binaryOperation()->getText());
+  auto opcode = stoinst(ctx->binaryOperation()->getText(), *operandLeftRef->type());
   IRBuilder(*currentBasicBlock).createBinaryInst(opcode,
                                                  {
                                                      .name = lhsName,
@@ -154,8 +246,9 @@ std::any ModuleBuilder::visitArithmeticInstruction(LLVMParser::ArithmeticInstruc
 std::any ModuleBuilder::visitComparisonInstruction(LLVMParser::ComparisonInstructionContext *ctx) {
   auto cmpOp = ctx->comparisonOperation()->getText();
   auto predicateStr = ctx->comparisonPredicate()->getText();
-  auto lhsRef = resolveValueUsage(ctx->value(0));
-  auto rhsRef = resolveValueUsage(ctx->value(1));
+  visitType(ctx->type());
+  auto lhsRef = resolveValueUsage(ctx->value(0), ctx->type()->typeRef);
+  auto rhsRef = resolveValueUsage(ctx->value(1), ctx->type()->typeRef);
   IRBuilder(*currentBasicBlock).createCmpInst(stoinst(cmpOp), {
       .ctx = *llvmContext,
       .name = ctx->unamedIdentifier()->getText(),
@@ -176,16 +269,38 @@ std::any ModuleBuilder::visitLoadInstruction(LLVMParser::LoadInstructionContext
   if (currentFunction->arg(destName))
     throw std::runtime_error("Variable name already exists in the function arguments");
 
-  auto src = resolveValueUsage(ctx->variable());
+  auto src = resolveVariableUsage(ctx->variable());
+  visitType(ctx->type(0));
   IRBuilder(*currentBasicBlock).createLoadInst({
                                                    .name = destName,
-                                                   .type = src->type(),
+                                                   .type = ctx->type(0)->typeRef,
                                                    .pointer = src
                                                });
+  return {};
 }
 
 std::any ModuleBuilder::visitStoreInstruction(LLVMParser::StoreInstructionContext *ctx) {
+  visitType(ctx->type(0));
+  auto value = resolveValueUsage(ctx->value(), ctx->type(0)->typeRef);
+  auto dest = resolveVariableUsage(ctx->variable());
+  IRBuilder(*currentBasicBlock).createStoreInst({
+                                                    .type = value->type(),
+                                                    .value = value,
+                                                    .pointer = dest
+                                                });
+  return {};
+}
 
+std::any ModuleBuilder::visitReturnInstruction(LLVMParser::ReturnInstructionContext *ctx) {
+  Ref<Value> value{};
+  visitType(ctx->type());
+  if (ctx->value())
+    value = resolveValueUsage(ctx->value(), ctx->type()->typeRef);
+  IRBuilder(*currentBasicBlock).createRetInst({
+                                                  .ctx = *llvmContext,
+                                                  .value = value
+                                              });
+  return {};
 }
 
 std::any ModuleBuilder::visitAllocaInstruction(LLVMParser::AllocaInstructionContext *ctx) {
@@ -195,9 +310,9 @@ std::any ModuleBuilder::visitAllocaInstruction(LLVMParser::AllocaInstructionCont
   int hasAlign = ctx->Align() != nullptr;
   // ctx should have hasAlign integer literals, if there is more, it should have size
   int hasSize = ctx->IntegerLiteral().size() > hasAlign;
-  size_t size = hasSize ? std::stoul(ctx->IntegerLiteral(0)->getText()) : 1;
+  uint32_t size = hasSize ? std::stoul(ctx->IntegerLiteral(0)->getText()) : 1;
   // 0 means no alignment required
-  size_t alignment = hasAlign ? std::stoul(ctx->IntegerLiteral().back()->getText()) : 0;
+  uint32_t alignment = hasAlign ? std::stoul(ctx->IntegerLiteral().back()->getText()) : 0;
   if (auto arg = currentFunction->arg(varName)) {
     // ERROR
     throw std::runtime_error("Variable name already exists in the function arguments");
@@ -233,18 +348,80 @@ std::any ModuleBuilder::visitGepInstruction(LLVMParser::GepInstructionContext *c
     throw std::runtime_error("Variable name already exists in the function locals");
   if (currentFunction->arg(gepValName))
     throw std::runtime_error("Variable name already exists in the function arguments");
-  auto val = resolveValueUsage(ctx->variable());
+  auto val = resolveVariableUsage(ctx->variable());
   auto indices = ctx->value();
   std::vector<Ref<Value>> indicesRef;
   indicesRef.reserve(indices.size());
   for (auto index : indices)
-    indicesRef.push_back(resolveValueUsage(index));
+    indicesRef.push_back(resolveValueUsage(index, llvmContext->intType()));
   IRBuilder(*currentBasicBlock).createGepInst({
                                                   .name = gepValName,
                                                   .type = val->type(),
-                                                  .val = val,
+                                                  .pointer = val,
                                                   .indices = std::move(indicesRef)
                                               });
   return {};
 }
-}
\ No newline at end of file
+
+std::any ModuleBuilder::visitBranchInstruction(LLVMParser::BranchInstructionContext *ctx) {
+  const auto &targets = ctx->localVariable();
+  if (!ctx->variable()) {
+    IRBuilder(*currentBasicBlock).createBrInst(*llvmContext, resolveBasicBlock(targets[0]));
+    return {};
+  }
+  IRBuilder(*currentBasicBlock).createBrInst(*llvmContext, BrInst::Conditional{
+      .cond = resolveVariableUsage(ctx->variable(), llvmContext->boolType()),
+      .thenBranch = resolveBasicBlock(targets[0]),
+      .elseBranch = resolveBasicBlock(targets[1])
+  });
+  return {};
+}
+
+std::any ModuleBuilder::visitPhiInstruction(LLVMParser::PhiInstructionContext *ctx) {
+  visitType(ctx->type());
+  auto type = ctx->type()->typeRef;
+  std::vector<PhiValue> incomingValues{};
+  for (auto phiValue : ctx->phiValue())
+    incomingValues.push_back({
+        .basicBlock = resolveBasicBlock(phiValue->localVariable()),
+        .value = resolveValueUsage(phiValue->value(), type)
+    });
+  auto name = variableName(ctx->unamedIdentifier());
+  IRBuilder(*currentBasicBlock).createPhiInst({
+      .name = name,
+      .type = type,
+      .incomingValues = std::move(incomingValues)
+  });
+  return {};
+}
+
+std::any ModuleBuilder::visitCallInstruction(LLVMParser::CallInstructionContext *ctx) {
+  auto calleeName = ctx->globalIdentifier()->NamedIdentifier()->getText();
+  if (!module->hasFunction(calleeName))
+    throw std::runtime_error("call to undeclared function @" + calleeName);
+  auto &callee = *module->function(calleeName);
+  const auto &calleeType = mystl::cast<FunctionType>(*callee.type());
+  const auto &args = ctx->callArguments()->callArgument();
+  if (args.size() != calleeType.argCount())
+    throw std::runtime_error("call to @" + calleeName + " with " + std::to_string(args.size())
+                                 + " arguments, which takes " + std::to_string(calleeType.argCount()));
+  std::vector<Ref<Value>> realArgs{};
+  realArgs.reserve(args.size());
+  for (size_t i = 0; i < args.size(); i++) {
+    if (auto number = args[i]->number()) {
+      realArgs.push_back(llvmContext->constant(llvmContext->stobt(number->scalarType()->getText()),
+                                               number->literal()->getText()));
+      continue;
+    }
+    realArgs.push_back(resolveVariableUsage(args[i]->variable(), calleeType.argType(i)));
+  }
+  visitType(ctx->type());
+  IRBuilder(*currentBasicBlock).createCallInst({
+      .name = ctx->unamedIdentifier() ? variableName(ctx->unamedIdentifier()) : "",
+      .type = ctx->type()->typeRef,
+      .function = callee,
+      .realArgs = realArgs
+  });
+  return {};
+}
+}
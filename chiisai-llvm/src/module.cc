@@ -9,18 +9,28 @@
 namespace llvm {
 
 Module &Module::addFunction(std::unique_ptr<Function> &&function) {
-  if (m_functionMap.find(function->name()) != m_functionMap.end())
+  if (!m_functionMap.try_emplace(function->symbol(), mystl::make_observer(function.get())).second)
     throw std::runtime_error("function already exists");
   functions.push_back(std::move(function));
-  m_functionMap[functions.back()->name()] = mystl::make_observer(functions.back().get());
   return *this;
 }
+Module &Module::addGlobalVariable(std::unique_ptr<GlobalVariable> &&globalVariable) {
+  if (!m_globalVariableMap.try_emplace(globalVariable->symbol(), mystl::make_observer(globalVariable.get())).second)
+    throw std::runtime_error("global variable already exists");
+  globalVariables.push_back(std::move(globalVariable));
+  return *this;
+}
+
+void Module::materializeAll() {
+  for (auto function : functions)
+    function->materialize();
+}
+
 void Module::accept(Executor &executor) {
   auto main = function("main");
   minilog::info("Executing main function of module {}", m_name);
-  executor.pushFrame();
-  executor.execute(main);
-  executor.popFrame();
+  executor.prepare();
+  executor.call(*main, {});
   minilog::info("Execution of main function of module {} finished", m_name);
 }
 }
\ No newline at end of file
@@ -0,0 +1,141 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <chiisai-llvm/perf-map.h>
+#include <chiisai-llvm/function.h>
+#include <minilog/logger.h>
+#if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__))
+#define CACTRIE_PERF_TRAMPOLINES 1
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+namespace llvm {
+
+#if defined(CACTRIE_PERF_TRAMPOLINES)
+// void trampoline(void *context, Body body) { body(context); }, with a frame pointer so that unwinding works
+#if defined(__x86_64__)
+static constexpr std::array<uint8_t, 8> TrampolineCode{
+    0x55,             // push %rbp
+    0x48, 0x89, 0xe5, // mov %rsp, %rbp
+    0xff, 0xd6,       // call *%rsi
+    0x5d,             // pop %rbp
+    0xc3,             // ret
+};
+#else
+static constexpr std::array<uint32_t, 5> TrampolineWords{
+    0xa9bf7bfd, // stp x29, x30, [sp, #-16]!
+    0x910003fd, // mov x29, sp
+    0xd63f0020, // blr x1
+    0xa8c17bfd, // ldp x29, x30, [sp], #16
+    0xd65f03c0, // ret
+};
+#endif
+static constexpr size_t TrampolineSize = 32;
+static constexpr size_t CodePageSize = 4096;
+#endif
+
+bool PerfMap::supported() {
+#if defined(CACTRIE_PERF_TRAMPOLINES)
+  return true;
+#else
+  return false;
+#endif
+}
+
+PerfMap::PerfMap() {
+#if defined(CACTRIE_PERF_TRAMPOLINES)
+  auto path = "/tmp/perf-" + std::to_string(getpid()) + ".map";
+  m_mapFile = std::fopen(path.c_str(), "a");
+  if (!m_mapFile)
+    minilog::warn("failed to open {}, interpreted functions will not be named in profiles", path);
+#endif
+}
+
+PerfMap::~PerfMap() {
+#if defined(CACTRIE_PERF_TRAMPOLINES)
+  // perf resolves the names after the process exits, so the map file is kept
+  if (m_mapFile)
+    std::fclose(m_mapFile);
+  for (const auto &page : m_codePages)
+    munmap(page.base, CodePageSize);
+#endif
+}
+
+PerfMap::Trampoline PerfMap::trampoline(const Function &function) {
+  auto it = m_trampolines.find(cref(function));
+  if (it != m_trampolines.end())
+    return it->second;
+#if defined(CACTRIE_PERF_TRAMPOLINES)
+  if (m_unavailable)
+    return m_trampolines.emplace(cref(function), nullptr).first->second;
+  // a W^X policy, e.g. SELinux without execmem, may refuse executable pages, in which case functions are called directly
+  auto fail = [&](const char *what) {
+    minilog::warn("{} failed: {}, interpreted functions will not be named in profiles", what, std::strerror(errno));
+    m_unavailable = true;
+    return m_trampolines.emplace(cref(function), nullptr).first->second;
+  };
+  if (m_codePages.empty() || m_codePages.back().used + TrampolineSize > CodePageSize) {
+    void *base = mmap(nullptr, CodePageSize, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+      return fail("mapping an executable page");
+    m_codePages.push_back({.base = static_cast<std::byte *>(base)});
+  }
+  auto &page = m_codePages.back();
+  auto code = page.base + page.used;
+  // the page is only writable while a trampoline is being written into it
+  if (mprotect(page.base, CodePageSize, PROT_READ | PROT_WRITE) != 0)
+    return fail("making a trampoline page writable");
+#if defined(__x86_64__)
+  std::memcpy(code, TrampolineCode.data(), TrampolineCode.size());
+#else
+  std::memcpy(code, TrampolineWords.data(), sizeof(TrampolineWords));
+#endif
+  if (mprotect(page.base, CodePageSize, PROT_READ | PROT_EXEC) != 0)
+    return fail("making a trampoline page executable");
+  __builtin___clear_cache(reinterpret_cast<char *>(code), reinterpret_cast<char *>(code + TrampolineSize));
+  page.used += TrampolineSize;
+  if (m_mapFile) {
+    std::fprintf(m_mapFile, "%lx %zx cact::%s\n",
+                 reinterpret_cast<unsigned long>(code), TrampolineSize, function.name().c_str());
+    std::fflush(m_mapFile);
+  }
+  return m_trampolines.emplace(cref(function), reinterpret_cast<Trampoline>(code)).first->second;
+#else
+  return m_trampolines.emplace(cref(function), nullptr).first->second;
+#endif
+}
+
+namespace {
+// the trampolines have no unwind tables, so exceptions are carried across them instead of thrown through them
+struct GuardedBody {
+  PerfMap::Body body;
+  void *context;
+  std::exception_ptr exception{};
+};
+}
+
+void PerfMap::run(const Function &function, Body body, void *context) {
+  auto entry = trampoline(function);
+  if (!entry) {
+    body(context);
+    return;
+  }
+  GuardedBody guarded{.body = body, .context = context};
+  entry(&guarded, [](void *opaque) {
+    auto &guarded = *static_cast<GuardedBody *>(opaque);
+    try {
+      guarded.body(guarded.context);
+    } catch (...) {
+      guarded.exception = std::current_exception();
+    }
+  });
+  if (guarded.exception)
+    std::rethrow_exception(guarded.exception);
+}
+
+}
@@ -1,23 +1,33 @@
 //
 // Created by creeper on 10/17/24.
 //
-#include <map>
 #include <string>
+#include <stdexcept>
 #include <chiisai-llvm/predicate.h>
+#include <chiisai-llvm/mystl/flat_hash_map.h>
 namespace llvm {
-Predicate stopdct(const std::string &str) {
-  std::map<std::string, Predicate> mapping{
-      {"eq", Predicate::EQ},
-      {"ne", Predicate::NE},
-      {"ugt", Predicate::UGT},
-      {"uge", Predicate::UGE},
-      {"ult", Predicate::ULT},
-      {"ule", Predicate::ULE},
-      {"sgt", Predicate::SGT},
-      {"sge", Predicate::SGE},
-      {"slt", Predicate::SLT},
-      {"sle", Predicate::SLE},
-  };
-  return mapping.at(str);
+Predicate stopdct(std::string_view str) {
+  // only read once built, like the table of stoinst
+  static const mystl::flat_hash_map<std::string_view, Predicate> mapping = [] {
+    mystl::flat_hash_map<std::string_view, Predicate> predicates{};
+    for (auto [name, predicate] : std::initializer_list<std::pair<std::string_view, Predicate>>{
+        {"eq", Predicate::EQ},
+        {"ne", Predicate::NE},
+        {"ugt", Predicate::UGT},
+        {"uge", Predicate::UGE},
+        {"ult", Predicate::ULT},
+        {"ule", Predicate::ULE},
+        {"sgt", Predicate::SGT},
+        {"sge", Predicate::SGE},
+        {"slt", Predicate::SLT},
+        {"sle", Predicate::SLE},
+    })
+      predicates[name] = predicate;
+    return predicates;
+  }();
+  auto it = mapping.find(str);
+  if (it == mapping.end())
+    throw std::runtime_error("unknown predicate " + std::string(str));
+  return it->second;
+}
 }
-}
\ No newline at end of file
@@ -0,0 +1,108 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <thread>
+#include <antlr4-runtime.h>
+#include <chiisai-llvm/program.h>
+#include <chiisai-llvm/bitcode.h>
+#include <chiisai-llvm/asm-parser.h>
+#include <chiisai-llvm/code-cache.h>
+#include <chiisai-llvm/mapped-file.h>
+#include <chiisai-llvm/module-builder.h>
+#include <chiisai-llvm/mapped-char-stream.h>
+#include <chiisai-llvm/autogen/LLVMLexer.h>
+#include <chiisai-llvm/autogen/LLVMParser.h>
+#include <chiisai-llvm/mystl/castings.h>
+
+namespace llvm {
+
+Program::Program(std::unique_ptr<LLVMContext> ctx, std::unique_ptr<Module> module)
+    : m_ctx(std::move(ctx)), m_module(std::move(module)),
+      m_executor(std::make_unique<Executor>(*m_module, *m_ctx)) {}
+
+namespace {
+
+// a module of textual IR, with the context it is built in
+std::pair<std::unique_ptr<LLVMContext>, std::unique_ptr<Module>> readText(const std::string &path,
+                                                                           Program::TextParser textParser) {
+  if (textParser == Program::TextParser::Fast) {
+    auto ctx = std::make_unique<LLVMContext>();
+    auto module = readAssembly(path, *ctx, std::thread::hardware_concurrency());
+    return {std::move(ctx), std::move(module)};
+  }
+  // lexed straight from the mapping, which throws if the file cannot be opened
+  MappedCharStream input(path);
+  LLVMLexer lexer(&input);
+  antlr4::CommonTokenStream tokens(&lexer);
+  LLVMParser parser(&tokens);
+  auto tree = parser.module();
+  // the parser recovers from syntax errors, which would leave the builder with a partial tree
+  if (lexer.getNumberOfSyntaxErrors() || parser.getNumberOfSyntaxErrors())
+    throw std::runtime_error("syntax errors in " + path);
+  ModuleBuilder builder{};
+  builder.visitModule(tree);
+  return {std::move(builder.llvmContext), std::move(builder.module)};
+}
+
+}
+
+std::unique_ptr<Program> Program::parse(const std::string &path, TextParser textParser, CodeCache *codeCache) {
+  if (isBitcode(path)) {
+    auto ctx = std::make_unique<LLVMContext>();
+    auto module = readBitcode(path, *ctx);
+    return std::make_unique<Program>(std::move(ctx), std::move(module));
+  }
+  if (!codeCache) {
+    auto [ctx, module] = readText(path, textParser);
+    return std::make_unique<Program>(std::move(ctx), std::move(module));
+  }
+  MappedFile source(path);
+  auto cachedCtx = std::make_unique<LLVMContext>();
+  if (auto module = codeCache->load(source.text(), *cachedCtx))
+    return std::make_unique<Program>(std::move(cachedCtx), std::move(module));
+  auto [ctx, module] = readText(path, textParser);
+  codeCache->store(source.text(), *module);
+  return std::make_unique<Program>(std::move(ctx), std::move(module));
+}
+
+Program &Program::prepare() {
+  if (m_prepared)
+    return *this;
+  link();
+  m_executor->prepare();
+  for (auto function : m_module->functions)
+    if (!function->isDeclaration() || m_executor->nativeFunction(*function))
+      m_exports.emplace(function->symbol(), function);
+  m_prepared = true;
+  return *this;
+}
+
+void Program::link() {
+  for (auto function : m_module->functions) {
+    // bodies that are not materialized are left alone, calling an unresolved function from them throws when it is called
+    if (!function->isMaterialized())
+      continue;
+    for (const auto &basicBlock : function->basicBlocks)
+      basicBlock.forEachInstruction<CallInst>([this](Ref<CallInst> call) {
+        const auto &callee = call->function;
+        if (callee.isDeclaration() && !m_executor->nativeFunction(callee))
+          throw std::runtime_error("unresolved function " + callee.name() + " called in " + call->basicBlock().function().name());
+      });
+  }
+}
+
+Function &Program::exportedFunction(const std::string &name) {
+  if (!m_prepared)
+    throw std::runtime_error("invoking " + name + " before the program is prepared");
+  auto symbol = m_ctx->symbols().find(name);
+  auto it = symbol ? m_exports.find(*symbol) : m_exports.end();
+  if (it == m_exports.end())
+    throw std::runtime_error("function " + name + " is not exported by the program");
+  return *it->second;
+}
+
+const FunctionType &Program::functionType(const Function &function) {
+  return *mystl::staticCast<const FunctionType>(function.type());
+}
+
+}
@@ -0,0 +1,41 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <mutex>
+#include <chiisai-llvm/symbol.h>
+
+namespace llvm {
+
+Symbol SymbolTable::intern(std::string_view name) {
+  if (name.empty())
+    return {};
+  {
+    std::shared_lock lock(m_mutex);
+    if (auto it = m_symbols.find(name); it != m_symbols.end())
+      return Symbol(it->second);
+  }
+  std::unique_lock lock(m_mutex);
+  if (auto it = m_symbols.find(name); it != m_symbols.end())
+    return Symbol(it->second);
+  // the name is stored before its symbol is handed out, and whoever gets the symbol from another thread
+  // gets it through something that orders the two, so reading the name takes no lock
+  auto &stored = m_names.emplace_back(Symbol::Interned{.name = std::string(name), .hash = Symbol::hashName(name)});
+  m_symbols.emplace(stored.name, &stored);
+  return Symbol(&stored);
+}
+
+std::optional<Symbol> SymbolTable::find(std::string_view name) const {
+  if (name.empty())
+    return Symbol{};
+  std::shared_lock lock(m_mutex);
+  if (auto it = m_symbols.find(name); it != m_symbols.end())
+    return Symbol(it->second);
+  return std::nullopt;
+}
+
+size_t SymbolTable::size() const {
+  std::shared_lock lock(m_mutex);
+  return m_names.size();
+}
+
+}
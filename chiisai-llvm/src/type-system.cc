@@ -0,0 +1,102 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <ranges>
+#include <algorithm>
+#include <stdexcept>
+#include <chiisai-llvm/type-system.h>
+#include <chiisai-llvm/mystl/hash.h>
+
+namespace llvm {
+
+TypeSystem::TypeSystem(LLVMContext &ctx) : m_ctx(ctx) {
+  for (auto type : {&voidInstance, &floatInstance, &doubleInstance,
+                    static_cast<Type *>(&boolInstance), static_cast<Type *>(&intInstance),
+                    static_cast<Type *>(&longInstance)})
+    enroll(*type);
+}
+
+TypeSystem::~TypeSystem() {
+  for (auto &chunk : typeChunks)
+    delete[] chunk.load(std::memory_order_relaxed);
+}
+
+CRef<Type> TypeSystem::stobt(std::string_view str) const {
+  if (str == "int")
+    return cref(intInstance);
+  if (str == "void")
+    return cref(voidInstance);
+  if (str == "float")
+    return cref(floatInstance);
+  if (str == "double")
+    return cref(doubleInstance);
+  if (str == "bool")
+    return cref(boolInstance);
+  if (str == "long")
+    return cref(longInstance);
+  return nullptr;
+}
+
+size_t TypeSystem::ArrayTypeKeyHash::operator()(const ArrayTypeKey &key) const {
+  size_t hashCode{};
+  mystl::hash_combine(hashCode, key.element);
+  mystl::hash_combine(hashCode, key.size);
+  return hashCode;
+}
+
+bool TypeSystem::FunctionTypeKey::operator==(const FunctionTypeKey &other) const {
+  return std::ranges::equal(contained, other.contained);
+}
+
+size_t TypeSystem::FunctionTypeKeyHash::operator()(const FunctionTypeKey &key) const {
+  size_t hashCode{};
+  for (auto id : key.contained)
+    mystl::hash_combine(hashCode, id);
+  return hashCode;
+}
+
+CRef<ArrayType> TypeSystem::arrayType(CRef<Type> elementType, size_t size) {
+  return cref(arrayTypes.intern({elementType->id(), size}, [&] {
+    return registered(std::make_unique<ArrayType>(elementType, size));
+  }));
+}
+
+CRef<PointerType> TypeSystem::pointerType(CRef<Type> elementType) {
+  return cref(pointerTypes.intern(elementType->id(), [&] {
+    return registered(std::make_unique<PointerType>(elementType));
+  }));
+}
+
+CRef<FunctionType> TypeSystem::functionType(std::span<const CRef<Type>> containedTypes) {
+  FunctionTypeKey key{mystl::small_vector<uint32_t, 6>(
+      containedTypes | std::views::transform([](CRef<Type> type) { return type->id(); }))};
+  return cref(functionTypes.intern(key, [&] {
+    return registered(std::make_unique<FunctionType>(containedTypes[0], containedTypes.subspan(1)));
+  }));
+}
+
+CRef<Type> TypeSystem::type(uint32_t id) const {
+  // whoever holds the id got it from a type that was enrolled, and so published, before it was handed out
+  return mystl::make_observer(typeChunks[id >> ChunkBits].load(std::memory_order_acquire)[id & (ChunkSize - 1)]);
+}
+
+void TypeSystem::enroll(Type &type) {
+  auto id = typeCount.fetch_add(1, std::memory_order_relaxed);
+  if (id >> ChunkBits >= MaxChunks)
+    throw std::runtime_error("too many distinct types");
+  type.m_id = id;
+  type.m_context = &m_ctx;
+  auto &chunk = typeChunks[id >> ChunkBits];
+  auto slots = chunk.load(std::memory_order_acquire);
+  if (!slots) {
+    // the first type of a chunk allocates it, and a thread that loses the race frees its copy
+    auto fresh = new const Type *[ChunkSize]{};
+    if (chunk.compare_exchange_strong(slots, fresh, std::memory_order_acq_rel, std::memory_order_acquire))
+      slots = fresh;
+    else
+      delete[] fresh;
+  }
+  slots[id & (ChunkSize - 1)] = &type;
+}
+
+}
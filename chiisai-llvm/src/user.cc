@@ -2,18 +2,58 @@
 // Created by creeper on 10/14/24.
 //
 #include <chiisai-llvm/user.h>
-#include <minilog/logger.h>
 #include <chiisai-llvm/value.h>
+#include <chiisai-llvm/instruction.h>
 
 namespace llvm {
-void addUse(Ref<User> user, Ref<Value> value) {
-  static auto useDefLogger = minilog::createFileLogger("useDef.log", minilog::LogLevel::debug);
-  if (user == nullptr)
-    throw std::runtime_error("user is nullptr");
+
+void Use::link(Value *value) {
+  m_nextUse = value->m_useHead;
+  if (m_nextUse)
+    m_nextUse->m_prevUse = &m_nextUse;
+  m_prevUse = &value->m_useHead;
+  value->m_useHead = this;
+}
+
+void Use::unlink() {
+  *m_prevUse = m_nextUse;
+  if (m_nextUse)
+    m_nextUse->m_prevUse = m_prevUse;
+  m_prevUse = nullptr;
+  m_nextUse = nullptr;
+}
+
+void Use::set(Ref<Value> value) {
   if (value == nullptr)
+    throw std::runtime_error("cannot bind an operand of " + m_user->name() + " to nullptr");
+  if (isLinked())
+    unlink();
+  link(value.get());
+  *m_slot = value;
+  if (auto inst = mystl::dyn_cast<Instruction>(m_user))
+    inst->operandChanged();
+}
+
+Use &User::appendOperand(Ref<Value> &slot, mystl::arena &storage) {
+  if (slot == nullptr)
     throw std::runtime_error("value is nullptr");
-  user->m_usedValues.push_back(value);
-  value->m_users.push_back(user);
-  useDefLogger->debug("add use: {} -> {}", user->name(), value->name());
+  // uses are trivially destructible, their memory goes with the arena
+  auto &use = *new(storage.allocate(sizeof(Use), alignof(Use))) Use(*this, slot);
+  use.link(slot.get());
+  (m_operandTail ? m_operandTail->m_nextOperand : m_operandHead) = &use;
+  m_operandTail = &use;
+  return use;
+}
+
+User::~User() {
+  for (auto use = m_operandHead; use; use = use->m_nextOperand)
+    if (use->isLinked())
+      use->unlink();
+}
+
+void addUse(Ref<User> user, Ref<Value> &slot, mystl::arena &storage) {
+  if (user == nullptr)
+    throw std::runtime_error("user is nullptr");
+  user->appendOperand(slot, storage);
+}
 }
-}
\ No newline at end of file
@@ -1,13 +1,41 @@
 //
 // Created by creeper on 10/14/24.
 //
+#include <stdexcept>
 #include <chiisai-llvm/value.h>
+#include <chiisai-llvm/user.h>
+#include <chiisai-llvm/llvm-context.h>
 
 namespace llvm {
+
+namespace {
+Symbol internName(const std::string &name, CRef<Type> type) {
+  if (name.empty())
+    return {};
+  if (!type || !type->hasContext())
+    throw std::runtime_error("cannot name " + name + " without a type of a context to intern the name in");
+  return type->context().symbols().intern(name);
+}
+}
+
+Value::Value(Kind kind, const std::string &name, CRef<Type> type) : Value(kind, internName(name, type), type) {}
+
 void Value::replaceAllUsesWith(Ref<Value> other) {
-  assert(other.get() != this);
-  for (auto user : users()) {
+  if (other.get() == this)
+    throw std::runtime_error("cannot replace " + name() + " with itself");
+  if (other->type() != type())
+    throw std::runtime_error("cannot replace " + name() + " with " + other->name() + " of another type");
+  // set() unlinks the use from this list, so the head is always the next use to rebind
+  while (m_useHead)
+    m_useHead->set(other);
+}
 
+Value::~Value() {
+  for (auto use = m_useHead; use;) {
+    auto next = use->m_nextUse;
+    use->m_prevUse = nullptr;
+    use->m_nextUse = nullptr;
+    use = next;
   }
 }
-}
\ No newline at end of file
+}
@@ -0,0 +1,93 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <vector>
+#include <fcntl.h>
+#include <chiisai-llvm/module.h>
+#include <chiisai-llvm/function.h>
+#include <chiisai-llvm/executor.h>
+#include <chiisai-llvm/asm-parser.h>
+#include <chiisai-llvm/asm-writer.h>
+#include <chiisai-llvm/llvm-context.h>
+#include "test.h"
+
+using namespace llvm;
+
+TEST(textRoundTripPrintsTheSame) {
+  for (const auto &path : test::suites()) {
+    LLVMContext ctx;
+    auto module = readAssembly(path, ctx);
+    auto printed = test::print(*module);
+    LLVMContext again;
+    CHECK(test::print(*parseAssembly(printed, again)) == printed);
+    // bodies built on several threads are the same as those built on one
+    LLVMContext parallel;
+    CHECK(test::print(*readAssembly(path, parallel, 4)) == printed);
+  }
+}
+
+TEST(grammarSyntaxRunsLikeAsmWriterSyntax) {
+  LLVMContext ctx;
+  auto module = readAssembly(test::suitesDir() / "grammar" / "loop.ll", ctx);
+  LLVMContext again;
+  auto printed = parseAssembly(test::print(*module), again);
+  for (auto m : {module.get(), printed.get()}) {
+    Executor executor(*m, m == module.get() ? ctx : again);
+    executor.prepare();
+    std::vector<Result> args{};
+    // 2 * (3 + 4 + 5 + 6) - 1
+    CHECK(std::get<int32_t>(executor.call(*m->function("main"), args)->value) == 35);
+  }
+}
+
+TEST(labelsAreDefinedOnce) {
+  LLVMContext ctx;
+  CHECK_THROWS(parseAssembly("define void @f() {\n"
+                             "entry:\n"
+                             "  br label %entry\n"
+                             "entry:\n"
+                             "  ret void\n"
+                             "}\n", ctx), std::runtime_error);
+}
+
+namespace {
+// more functions than the window of a few per thread, so the workers wait on the writer
+std::string manyFunctions(size_t count) {
+  std::string text{};
+  for (size_t k = 0; k < count; k++)
+    text += "define i32 @f" + std::to_string(k) + "(i32 %x) {\n"
+            "entry:\n"
+            "  %y = add i32 %x, " + std::to_string(k) + "\n"
+            "  ret i32 %y\n"
+            "}\n";
+  return text;
+}
+}
+
+TEST(parallelPrintMatchesSerialPrint) {
+  LLVMContext ctx;
+  auto module = parseAssembly(manyFunctions(64), ctx);
+  auto file = std::tmpfile();
+  CHECK(file);
+  {
+    AsmWriter writer(fileno(file), 256);
+    writer.printParallel(*module, 3);
+    writer.flush();
+  }
+  std::string text(static_cast<size_t>(std::ftell(file)), '\0');
+  std::rewind(file);
+  text.resize(std::fread(text.data(), 1, text.size(), file));
+  std::fclose(file);
+  CHECK(text == test::print(*module));
+}
+
+TEST(parallelPrintFailsOnAClosedDescriptor) {
+  LLVMContext ctx;
+  auto module = parseAssembly(manyFunctions(64), ctx);
+  auto fd = ::open("/dev/null", O_WRONLY);
+  CHECK(fd >= 0);
+  ::close(fd);
+  // the write fails while the workers are blocked on the window, which must release them
+  AsmWriter writer(fd, 64);
+  CHECK_THROWS(writer.printParallel(*module, 3), std::runtime_error);
+}
@@ -0,0 +1,127 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <chiisai-llvm/module.h>
+#include <chiisai-llvm/bitcode.h>
+#include <chiisai-llvm/code-cache.h>
+#include <chiisai-llvm/ir-mem-stats.h>
+#include <chiisai-llvm/instruction.h>
+#include <chiisai-llvm/function.h>
+#include <chiisai-llvm/asm-parser.h>
+#include <chiisai-llvm/llvm-context.h>
+#include "test.h"
+
+using namespace llvm;
+
+namespace {
+std::string slurp(const std::filesystem::path &path) {
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream text;
+  text << file.rdbuf();
+  return text.str();
+}
+}
+
+TEST(bitcodeRoundTripPrintsTheSame) {
+  for (const auto &path : test::suites()) {
+    LLVMContext ctx;
+    auto module = readAssembly(path, ctx);
+    auto printed = test::print(*module);
+    test::ScratchFile bitcode(path.stem().string() + ".bc");
+    writeBitcode(*module, bitcode.path);
+    CHECK(isBitcode(bitcode.path));
+    LLVMContext again;
+    auto loaded = readBitcode(bitcode.path, again);
+    // bodies are only decoded when they are first needed, which printing does
+    for (auto function : loaded->functions)
+      CHECK(function->isDeclaration() || !function->isMaterialized());
+    CHECK(test::print(*loaded) == printed);
+  }
+}
+
+TEST(failedMaterializationLeavesTheFunctionLazy) {
+  LLVMContext ctx;
+  auto module = readAssembly(test::suitesDir() / "loop.ll", ctx);
+  test::ScratchFile bitcode("loop.bc"), corrupted("loop-corrupted.bc");
+  writeBitcode(*module, bitcode.path);
+  auto bytes = slurp(bitcode.path);
+  size_t failures = 0;
+  // every word but those of the header is corrupted in turn, some of which break the body of sum
+  for (size_t offset = 12 * sizeof(uint32_t); offset + sizeof(uint32_t) <= bytes.size(); offset += sizeof(uint32_t)) {
+    auto copy = bytes;
+    uint32_t garbage = 0xfffffff0u;
+    std::memcpy(copy.data() + offset, &garbage, sizeof(garbage));
+    std::ofstream(corrupted.path, std::ios::binary) << copy;
+    LLVMContext again;
+    std::unique_ptr<Module> loaded{};
+    Ref<Function> sum{};
+    try {
+      loaded = readBitcode(corrupted.path, again);
+      sum = loaded->function("sum");
+    } catch (const std::runtime_error &) {
+      continue;
+    }
+    try {
+      sum->materialize();
+    } catch (const std::runtime_error &) {
+      failures++;
+      CHECK(!sum->isMaterialized() && sum->basicBlocks.empty());
+      CHECK_THROWS(sum->materialize(), std::runtime_error);
+    }
+  }
+  CHECK(failures > 0);
+}
+
+TEST(codeCacheKeysArtifactsBySource) {
+  test::ScratchFile directory("code-cache");
+  auto source = slurp(test::suitesDir() / "loop.ll");
+  LLVMContext ctx;
+  auto module = parseAssembly(source, ctx);
+  {
+    CodeCache cache(directory.path);
+    CHECK(!cache.load(source, ctx) && cache.stats().misses == 1);
+    cache.store(source, *module);
+    CHECK(cache.stats().stores == 1);
+  }
+  // a later run with the same source maps what the first one stored
+  CodeCache cache(directory.path);
+  LLVMContext warm;
+  auto loaded = cache.load(source, warm);
+  CHECK(loaded && cache.stats().hits == 1);
+  CHECK(test::print(*loaded) == test::print(*module));
+  // an edited source is keyed apart, even though it starts the same
+  LLVMContext edited;
+  CHECK(!cache.load(source + "\ndefine void @unused() {\nentry:\n  ret void\n}\n", edited));
+  CHECK(cache.stats().misses == 1 && cache.stats().rejected == 0);
+}
+
+TEST(irMemStatsCountsEveryClass) {
+  LLVMContext ctx;
+  auto module = readAssembly(test::suitesDir() / "loop.ll", ctx);
+  auto stats = IRMemStats::of(*module);
+  using OpClass = IRMemStats::OpClass;
+  // sum, main and unused: branches and returns, the adds, the load, and the phis, the icmp and the call
+  CHECK(stats[OpClass::Terminator].count == 6 && stats[OpClass::Binary].count == 2);
+  CHECK(stats[OpClass::Logical].count == 0 && stats[OpClass::Memory].count == 1 && stats[OpClass::Other].count == 4);
+  CHECK(stats[OpClass::Binary].objectBytes == 2 * sizeof(BinaryInst) && stats[OpClass::Binary].useBytes == 4 * sizeof(Use));
+  CHECK(stats[OpClass::Other].useBytes == 7 * sizeof(Use) && stats[OpClass::Other].spillBytes == 0);
+  auto total = stats.total();
+  size_t bytes = 0;
+  for (size_t i = 0; i < IRMemStats::OpClassCount; i++)
+    bytes += stats[static_cast<OpClass>(i)].bytes();
+  CHECK(total.count == 13 && total.bytes() == bytes);
+  CHECK(stats.functionCount == 3 && stats.lazyFunctionCount == 0 && stats.basicBlockCount == 6);
+  CHECK(stats.arenaBytes >= total.objectBytes && stats.arenaSlabCount > 0);
+  auto report = stats.str();
+  CHECK(report.find("module: 3 functions (0 not materialized), 6 blocks") != std::string::npos);
+  CHECK(report.find("\ntotal               13") != std::string::npos);
+  // the bodies of a module loaded from bitcode take no memory until they are decoded
+  test::ScratchFile bitcode("loop-stats.bc");
+  writeBitcode(*module, bitcode.path);
+  LLVMContext again;
+  auto lazy = IRMemStats::of(*readBitcode(bitcode.path, again));
+  CHECK(lazy.functionCount == 3 && lazy.lazyFunctionCount == 3 && lazy.total().count == 0);
+}
@@ -0,0 +1,25 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <iostream>
+#include <string_view>
+#include "test.h"
+
+int main(int argc, char *argv[]) {
+  std::string_view filter = argc > 1 ? argv[1] : "";
+  size_t passed = 0, failed = 0;
+  for (const auto &[name, body] : llvm::test::registry()) {
+    if (name.find(filter) == std::string::npos)
+      continue;
+    try {
+      body();
+      passed++;
+      std::cout << "[ OK ] " << name << std::endl;
+    } catch (const std::exception &e) {
+      failed++;
+      std::cout << "[FAIL] " << name << ": " << e.what() << std::endl;
+    }
+  }
+  std::cout << passed << " passed, " << failed << " failed" << std::endl;
+  return failed ? 1 : 0;
+}
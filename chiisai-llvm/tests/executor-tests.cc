@@ -0,0 +1,133 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <chiisai-llvm/cloner.h>
+#include <chiisai-llvm/module.h>
+#include <chiisai-llvm/function.h>
+#include <chiisai-llvm/executor.h>
+#include <chiisai-llvm/asm-parser.h>
+#include <chiisai-llvm/memory-arena.h>
+#include <chiisai-llvm/perf-map.h>
+#include <chiisai-llvm/instruction.h>
+#include <chiisai-llvm/llvm-context.h>
+#include "test.h"
+
+using namespace llvm;
+
+namespace {
+int32_t callInt(Executor &executor, Function &function, std::vector<Result> args) {
+  return std::get<int32_t>(executor.call(function, args)->value);
+}
+
+int32_t twice(int32_t x) {
+  return 2 * x;
+}
+
+double half(double x) {
+  return x / 2;
+}
+
+int32_t refuse(int32_t) {
+  throw std::runtime_error("refused");
+}
+}
+
+TEST(bindNativeDispatchesDeclarations) {
+  LLVMContext ctx;
+  auto module = parseAssembly("declare i32 @twice(i32 %x)\n"
+                              "\n"
+                              "define i32 @quad(i32 %x) {\n"
+                              "entry:\n"
+                              "  %y = call i32 @twice(i32 %x)\n"
+                              "  %z = call i32 @twice(i32 %y)\n"
+                              "  ret i32 %z\n"
+                              "}\n", ctx);
+  auto declared = module->function("twice");
+  auto quad = module->function("quad");
+  Executor executor(*module, ctx);
+  // only a declaration can be bound, and only to a host function of its signature
+  CHECK_THROWS(executor.bindNative(*quad, twice), std::runtime_error);
+  CHECK_THROWS(executor.bindNative(*declared, half), std::runtime_error);
+  CHECK(!executor.nativeFunction(*declared) && !executor.nativeFunction(*quad));
+  executor.bindNative(*declared, twice).prepare();
+  CHECK(executor.nativeFunction(*declared));
+  CHECK(callInt(executor, *quad, {Result{int32_t{5}}}) == 20);
+}
+
+TEST(osrContinuesHotLoopsInTheOptimizedVersion) {
+  LLVMContext ctx;
+  auto module = readAssembly(test::suitesDir() / "loop.ll", ctx);
+  auto sum = module->function("sum");
+  std::vector<std::unique_ptr<Function>> clones{};
+  // the optimized version is a faithful clone, or one that returns 1000 to tell where the call returned from
+  auto run = [&](bool marked) {
+    Executor executor(*module, ctx);
+    executor.enableOsr([&](Function &baseline) -> Ref<Function> {
+      auto &clone = *clones.emplace_back(cloneFunction(baseline, baseline.name() + ".osr", ctx));
+      if (marked)
+        clone.basicBlocks.back().instructions.back()->operands().begin().use->set(
+            ctx.constant(ctx.intType(), "1000"));
+      return ref(clone);
+    }, 3).prepare();
+    std::vector<int32_t> results{};
+    for (int32_t n : {10, 10, 2})
+      results.push_back(callInt(executor, *sum, {Result{n}}));
+    return results;
+  };
+  CHECK(run(false) == (std::vector<int32_t>{45, 45, 1}) && clones.size() == 1);
+  // the first call starts in the baseline and returns from the clone, and the later ones enter the clone,
+  // even the one whose loop is too short to get hot
+  CHECK(run(true) == (std::vector<int32_t>{1000, 1000, 1000}) && clones.size() == 2);
+}
+
+TEST(memoryArenaReusesRegionsInStackOrder) {
+  constexpr size_t MiB = size_t{1} << 20;
+  // regions are rounded up to a huge page, which is what the sizes below are measured against
+  MemoryArena arena(MemoryArena::Options{.regionSize = 1, .explicitHugePages = false, .transparentHugePages = false});
+  auto start = arena.mark();
+  auto first = arena.allocate(MiB, 8);
+  auto second = arena.allocate(3 * MiB / 2, 8);
+  CHECK(arena.stats().regions == 2 && arena.stats().usedBytes == 5 * MiB / 2);
+  arena.release(start);
+  CHECK(arena.stats().usedBytes == 0);
+  CHECK(arena.allocate(MiB, 8) == first && arena.allocate(3 * MiB / 2, 8) == second);
+  CHECK(arena.stats().regions == 2);
+  // a region too small for an allocation is kept after the one reserved for it, to be reused later
+  arena.release(start);
+  CHECK(arena.allocate(MiB, 8) == first);
+  arena.allocate(3 * MiB, 8);
+  CHECK(arena.stats().regions == 3);
+  CHECK(arena.allocate(3 * MiB / 2, 8) == second && arena.stats().regions == 3);
+  CHECK(arena.stats().usedBytes == 11 * MiB / 2 && arena.stats().peakUsedBytes == 11 * MiB / 2);
+  arena.release(start);
+  CHECK(arena.stats().usedBytes == 0 && arena.stats().peakUsedBytes == 11 * MiB / 2);
+  CHECK(arena.stats().allocations == 7);
+}
+
+TEST(perfMapCarriesExceptionsAcrossTrampolines) {
+  if (!PerfMap::supported())
+    return;
+  LLVMContext ctx;
+  auto module = parseAssembly("declare i32 @refuse(i32 %x)\n"
+                              "\n"
+                              "define i32 @perfMapped(i32 %x) {\n"
+                              "entry:\n"
+                              "  %y = call i32 @refuse(i32 %x)\n"
+                              "  ret i32 %y\n"
+                              "}\n", ctx);
+  {
+    Executor executor(*module, ctx);
+    executor.enablePerfMap().bindNative(*module->function("refuse"), refuse).prepare();
+    CHECK_THROWS(callInt(executor, *module->function("perfMapped"), {Result{int32_t{1}}}), std::runtime_error);
+  }
+  // where perf looks for it, whatever the temporary directory is
+  auto path = "/tmp/perf-" + std::to_string(getpid()) + ".map";
+  std::stringstream map;
+  map << std::ifstream(path).rdbuf();
+  CHECK(map.str().find(" cact::perfMapped\n") != std::string::npos);
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,36 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <fstream>
+#include <chiisai-llvm/program.h>
+#include "test.h"
+
+using namespace llvm;
+
+// parseAssembly claims to build the same IR as ModuleBuilder for the syntax of LLVMParser.g4, which this checks
+TEST(frontEndsBuildTheSameModule) {
+  size_t compared = 0;
+  for (const auto &entry : std::filesystem::directory_iterator(test::suitesDir() / "grammar")) {
+    if (entry.path().extension() != ".ll")
+      continue;
+    auto antlr = Program::parse(entry.path().string(), Program::TextParser::Antlr);
+    auto fast = Program::parse(entry.path().string(), Program::TextParser::Fast);
+    CHECK(test::print(fast->module()) == test::print(antlr->module()));
+    compared++;
+  }
+  CHECK(compared > 1);
+}
+
+TEST(frontEndsRunTheSame) {
+  auto path = (test::suitesDir() / "grammar" / "loop.ll").string();
+  auto antlr = Program::parse(path, Program::TextParser::Antlr);
+  auto fast = Program::parse(path, Program::TextParser::Fast);
+  CHECK(antlr->prepare().invoke<int32_t>("main") == 35);
+  CHECK(fast->prepare().invoke<int32_t>("main") == 35);
+}
+
+TEST(antlrFrontEndRejectsSyntaxErrors) {
+  test::ScratchFile source("broken.ll");
+  std::ofstream(source.path) << "define i32 @f() {\nentry:\n  ret i32 i32\n}\n";
+  CHECK_THROWS(Program::parse(source.path.string(), Program::TextParser::Antlr), std::runtime_error);
+}
@@ -0,0 +1,192 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <vector>
+#include <algorithm>
+#include <chiisai-llvm/cloner.h>
+#include <chiisai-llvm/module.h>
+#include <chiisai-llvm/function.h>
+#include <chiisai-llvm/executor.h>
+#include <chiisai-llvm/asm-parser.h>
+#include <chiisai-llvm/instruction.h>
+#include <chiisai-llvm/llvm-context.h>
+#include "test.h"
+
+using namespace llvm;
+
+namespace {
+int32_t callInt(Executor &executor, Function &function, std::vector<Result> args) {
+  return std::get<int32_t>(executor.call(function, args)->value);
+}
+}
+
+TEST(rauwRebindsEveryUse) {
+  LLVMContext ctx;
+  auto module = readAssembly(test::suitesDir() / "loop.ll", ctx);
+  auto sum = module->function("sum");
+  auto n = sum->lookup("%n");
+  auto i = sum->lookup("%i");
+  auto three = ctx.constant(ctx.intType(), "3");
+  CHECK(n->hasUses());
+  std::vector<Ref<User>> users(n->users().begin(), n->users().end());
+  n->replaceAllUsesWith(three);
+  CHECK(!n->hasUses());
+  for (auto user : users)
+    CHECK(std::ranges::count(user->usedValues(), Ref<Value>(three)) == 1);
+  // a phi operand is rebound as well, and can be rebound back through its use
+  auto i2 = sum->lookup("%i2");
+  i2->replaceAllUsesWith(i);
+  CHECK(!i2->hasUses());
+  auto &phi = mystl::cast<PhiInst>(*i);
+  CHECK(phi.incomingValues()[1].value == i);
+  std::next(phi.operands().begin()).use->set(i2);
+  CHECK(phi.incomingValues()[1].value == i2 && i2->hasUses());
+  Executor executor(*module, ctx);
+  executor.prepare();
+  // 0 + 1 + 2, with the bound replaced by three
+  CHECK(callInt(executor, *sum, {Result{int32_t{100}}}) == 3);
+}
+
+TEST(frameLayoutFollowsMutation) {
+  LLVMContext ctx;
+  auto module = readAssembly(test::suitesDir() / "loop.ll", ctx);
+  auto sum = module->function("sum");
+  Executor executor(*module, ctx);
+  executor.prepare();
+  CHECK(callInt(executor, *sum, {Result{int32_t{4}}}) == 6);
+  auto revision = sum->revision();
+  auto slots = executor.translate(*sum).size();
+  auto &exit = sum->basicBlocks.back();
+  std::string name = "%extra";
+  exit.createInstruction<BinaryInst>(Instruction::Add, exit, BinaryInstDetails{
+      .name = name, .type = ctx.intType(), .lhs = sum->lookup("%acc"), .rhs = ctx.constant(ctx.intType(), "1")});
+  CHECK(sum->revision() != revision);
+  CHECK(executor.translate(*sum).size() == slots + 1);
+  CHECK(callInt(executor, *sum, {Result{int32_t{4}}}) == 6);
+}
+
+TEST(globalInitializerMustMatchItsType) {
+  LLVMContext ctx;
+  std::string name = "@g";
+  auto details = GlobalVariableDetails{
+      .name = name, .type = ctx.arrayType(ctx.intType(), 2), .initializer = ctx.constant(ctx.intType(), "1")};
+  CHECK_THROWS(GlobalVariable(details), std::runtime_error);
+}
+
+TEST(branchRetargetsByIndex) {
+  LLVMContext ctx;
+  auto module = readAssembly(test::suitesDir() / "arith.ll", ctx);
+  auto mix = module->function("mix");
+  auto &entry = mix->basicBlocks.front();
+  auto &done = mix->basicBlocks.back();
+  auto br = mystl::cast<BrInst>(entry.instructions.back());
+  CHECK(br->successor(0) == ref(done) && br->successor(1) == ref(done));
+  CHECK(done.predecessors().size() == 2);
+  // both targets are the same block, so only the index tells which edge is meant
+  br->setSuccessor(1, entry);
+  CHECK(br->successor(0) == ref(done) && br->successor(1) == ref(entry));
+  CHECK(entry.successors()[0] == ref(done) && entry.successors()[1] == ref(entry));
+  CHECK(done.predecessors().size() == 1 && entry.predecessors().size() == 1);
+}
+
+TEST(grammarDivisionFollowsTheOperands) {
+  LLVMContext ctx;
+  auto module = parseAssembly("define i32 @idiv(i32 %a, i32 %b) {\n"
+                              "entry:\n"
+                              "  %q = div i32 %a, %b\n"
+                              "  ret i32 %q\n"
+                              "}\n"
+                              "define f64 @fdiv(f64 %a, f64 %b) {\n"
+                              "entry:\n"
+                              "  %q = div f64 %a, %b\n"
+                              "  ret f64 %q\n"
+                              "}\n", ctx);
+  auto opCode = [&](const char *name) {
+    return module->function(name)->basicBlocks.front().instructions.front()->opCode;
+  };
+  CHECK(opCode("idiv") == Instruction::SDiv);
+  CHECK(opCode("fdiv") == Instruction::FDiv);
+}
+
+TEST(symbolsHashTheirNamesOnce) {
+  SymbolTable table;
+  auto symbol = table.intern("@total");
+  // a table keyed by symbols is probed with names, so both must land in the same slot
+  CHECK(symbol.nameHash() == SymbolNameHash{}(std::string_view("@total")));
+  CHECK(SymbolNameHash{}(Symbol{}) == SymbolNameHash{}(std::string_view()));
+  SymbolMap<int> map{};
+  map.try_emplace(symbol, 1);
+  map.try_emplace(table.intern("@bias"), 2);
+  CHECK(map.contains(std::string_view("@total")) && map.find(std::string_view("@bias"))->second == 2);
+  CHECK(!map.contains(std::string_view("@weights")));
+}
+
+TEST(hashConsFindsIdenticalInstructions) {
+  LLVMContext ctx;
+  auto module = parseAssembly("define i32 @f(i32 %x, i32 %y) {\n"
+                              "entry:\n"
+                              "  %a = add i32 %x, %y\n"
+                              "  %b = add i32 %x, %y\n"
+                              "  %c = icmp slt i32 %x, %y\n"
+                              "  %d = icmp sgt i32 %x, %y\n"
+                              "  %s = add i32 %a, %b\n"
+                              "  ret i32 %s\n"
+                              "}\n", ctx);
+  auto f = module->function("f");
+  auto &table = f->hashCons();
+  auto inst = [&](std::string_view name) -> Instruction & {
+    return mystl::cast<Instruction>(*f->lookup(name));
+  };
+  auto &a = inst("%a"), &b = inst("%b");
+  auto &c = mystl::cast<CmpInst>(inst("%c")), &d = mystl::cast<CmpInst>(inst("%d"));
+  CHECK(table.insert(a) == ref(a) && table.insert(b) == ref(a) && table.size() == 1);
+  CHECK(table.find(b) == ref(a) && !table.find(a));
+  // the predicates tell the comparisons apart, and changing one rehashes it
+  CHECK(table.insert(c) == ref<Instruction>(c) && !table.find(d));
+  d.setPredicate(Predicate::SLT);
+  CHECK(table.find(d) == ref<Instruction>(c));
+  c.setPredicate(Predicate::SGT);
+  CHECK(table.size() == 1 && !table.find(d));
+  // rebinding an operand takes its users out of the table, and they can be inserted again with the new hash
+  f->lookup("%y")->replaceAllUsesWith(f->lookup("%x"));
+  CHECK(table.size() == 0 && !table.find(b));
+  CHECK(table.insert(b) == ref(b) && table.insert(a) == ref(b));
+  CHECK(table.insert(d) == ref<Instruction>(d) && table.size() == 2);
+  // and so does destroying it
+  auto &entry = f->basicBlocks.front();
+  entry.instructions.erase(entry.instructions.iterator_to(d));
+  CHECK(table.size() == 1);
+}
+
+TEST(clonesRunLikeTheirOriginals) {
+  LLVMContext ctx;
+  auto module = readAssembly(test::suitesDir() / "loop.ll", ctx);
+  auto sum = module->function("sum");
+  auto clone = cloneFunction(*sum, "sum.clone", ctx);
+  CHECK(clone->type() == sum->type() && clone->args().size() == 1);
+  // %i2 is used by a phi before it is defined, which the cloner reads through a stand-in until it is copied
+  auto &phi = mystl::cast<PhiInst>(*clone->lookup("%i"));
+  CHECK(phi.incomingValues()[1].value == clone->lookup("%i2"));
+  CHECK(phi.incomingValues()[1].basicBlock == ref(*std::next(clone->basicBlocks.begin(), 2)));
+  CHECK(clone->lookup("%i2")->hasUses() && sum->lookup("%i2") != clone->lookup("%i2"));
+  Executor executor(*module, ctx);
+  executor.prepare();
+  for (int32_t n : {0, 1, 7})
+    CHECK(callInt(executor, *clone, {Result{n}}) == callInt(executor, *sum, {Result{n}}));
+}
+
+TEST(specializationDropsBoundArguments) {
+  LLVMContext ctx;
+  auto module = readAssembly(test::suitesDir() / "loop.ll", ctx);
+  auto sum = module->function("sum");
+  std::vector<Ref<Value>> three{ctx.constant(ctx.intType(), "3")};
+  auto specialized = specializeFunction(*sum, "sum.3", three, ctx);
+  CHECK(specialized->args().empty() && specialized->type() != sum->type());
+  Executor executor(*module, ctx);
+  executor.prepare();
+  // 0 + 1 + 2
+  CHECK(callInt(executor, *specialized, {}) == 3);
+  std::vector<Ref<Value>> half{ctx.constant(ctx.doubleType(), "0.5")};
+  CHECK_THROWS(specializeFunction(*sum, "sum.half", half, ctx), std::runtime_error);
+  CHECK_THROWS(specializeFunction(*sum, "sum.none", std::vector<Ref<Value>>{}, ctx), std::runtime_error);
+}
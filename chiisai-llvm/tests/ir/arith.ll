@@ -0,0 +1,33 @@
+@table = global [3 x f64] [f64 0.5, f64 1.5, f64 2.5]
+
+define f64 @mean(i32 %n) {
+entry:
+  br label %loop
+loop:
+  %i = phi i32 [ 0, %entry ], [ %next, %body ]
+  %acc = phi f64 [ 0.0, %entry ], [ %sum, %body ]
+  %more = icmp slt i32 %i, %n
+  br i1 %more, label %body, label %exit
+body:
+  %p = getelementptr [3 x f64], [3 x f64]* @table, i32 0, i32 %i
+  %x = load f64, f64* %p
+  %sum = fadd f64 %acc, %x
+  %next = add i32 %i, 1
+  br label %loop
+exit:
+  %mean = fdiv f64 %acc, 3.0
+  ret f64 %mean
+}
+
+define i32 @mix(i32 %a, i32 %b) {
+entry:
+  %q = sdiv i32 %a, %b
+  %r = srem i32 %a, %b
+  %s = shl i32 %q, 2
+  %t = xor i32 %s, %r
+  %u = ashr i32 %t, 1
+  %same = icmp eq i32 %a, %b
+  br i1 %same, label %done, label %done
+done:
+  ret i32 %u
+}
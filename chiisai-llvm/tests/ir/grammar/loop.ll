@@ -0,0 +1,43 @@
+global i32 @total, align 0
+global i32 @bias, align 3
+
+define i32 @weigh(i32 %i, i32 %v) {
+entry:
+  %1 = load i32, i32* @bias
+  %2 = add i32 %1, %i
+  %3 = mul i32 %2, %v
+  ret i32 %3
+}
+
+define i32 @sum(i32 %n) {
+entry:
+  br label %loop
+loop:
+  %1 = phi i32 { %entry, i32 0 }, { %body, %4 }
+  %2 = phi i32 { %entry, i32 0 }, { %body, %5 }
+  %3 = icmp slt i32 %1, %n
+  br i1 %3, label %body, label %exit
+body:
+  %6 = call i32 @weigh(i32 %1, i32 2)
+  %4 = add i32 %1, i32 1
+  %5 = add i32 %2, %6
+  br label %loop
+exit:
+  store i32 %2, i32* @total
+  ret i32 %2
+}
+
+define i32 @main() {
+entry:
+  %1 = call i32 @sum(i32 4)
+  %2 = call i32 @later(i32 %1)
+  ret i32 %2
+}
+
+define i32 @later(i32 %x) {
+entry:
+  %1 = sub i32 %x, i32 1
+  br label %done
+done:
+  ret i32 %1
+}
@@ -0,0 +1,28 @@
+global f64 @scale, align 2.5
+global i32 @counter
+global [4 x i32] @weights, align [i32 4 x i32 3, i32 1, i32 4, i32 1]
+
+define i32 @blend(i32 %a, i32 %b) {
+entry:
+  %p = alloca i32
+  store i32 %a, i32* %p
+  %1 = load i32, i32* %p
+  %2 = mul i32 %1, %b
+  %3 = sub i32 %2, %a
+  %4 = div i32 %3, %b
+  %5 = add i32 %4, i32 7
+  %6 = icmp slt i32 %5, %b
+  %7 = getelementptr i32, i32* %p, %a
+  %8 = getelementptr [4 x i32], [4 x i32]* @weights, i32 0, %a
+  store i32 %5, i32* @counter
+  ret i32 %5
+}
+
+define f64 @scaled(f64 %x) {
+entry:
+  %1 = load f64, f64* @scale
+  %2 = mul f64 %x, %1
+  %3 = div f64 %2, f64 1.5
+  %4 = sub f64 %3, f64 0.5
+  ret f64 %4
+}
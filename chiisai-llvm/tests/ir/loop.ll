@@ -0,0 +1,29 @@
+@g = global [4 x i32] [i32 5, i32 6]
+
+define i32 @sum(i32 %n) {
+entry:
+  br label %loop
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i2, %body ]
+  %acc = phi i32 [ 0, %entry ], [ %acc2, %body ]
+  %c = icmp slt i32 %i, %n
+  br i1 %c, label %body, label %exit
+body:
+  %acc2 = add i32 %acc, %i
+  %i2 = add i32 %i, 1
+  br label %loop
+exit:
+  ret i32 %acc
+}
+
+define i32 @main() {
+entry:
+  %v = load i32, [4 x i32]* @g
+  %r = call i32 @sum(i32 %v)
+  ret i32 %r
+}
+
+define i32 @unused() {
+entry:
+  ret i32 7
+}
@@ -0,0 +1,27 @@
+@arr = constant [2 x [2 x i32]] [[2 x i32] [i32 1, i32 2], [2 x i32] [i32 3, i32 4]]
+@z = global i64 zeroinitializer
+
+define i32 @twice(i32 %x) {
+entry:
+  br label %tail
+head:
+  %0 = add i32 %1, 0
+  ret i32 %0
+tail:
+  %1 = call i32 @helper(i32 %x, i32 2)
+  br label %head
+}
+
+declare void @putint(i32 %0)
+
+define i32 @helper(i32 %a, i32 %b) {
+entry:
+  %p = alloca i32, align 4
+  store i32 %a, i32* %p
+  %v = load i32, i32* %p
+  %m = mul i32 %v, %b
+  %f = fadd f64 1.5, 2.25
+  %t = icmp eq i64 1, -2
+  %b1 = add i64 1, -2
+  ret i32 %m
+}
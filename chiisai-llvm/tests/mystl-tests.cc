@@ -0,0 +1,181 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <chiisai-llvm/mystl/ilist.h>
+#include <chiisai-llvm/mystl/small_vector.h>
+#include <chiisai-llvm/mystl/flat_hash_map.h>
+#include <chiisai-llvm/mystl/sharded_interner.h>
+#include "test.h"
+
+using namespace llvm;
+
+TEST(smallVectorGrowsOutOfInlineStorage) {
+  mystl::small_vector<std::string, 2> strings{};
+  strings.push_back("a");
+  strings.push_back("b");
+  CHECK(strings.is_inline());
+  for (int i = 0; i < 100; i++)
+    strings.push_back(std::to_string(i));
+  CHECK(!strings.is_inline());
+  CHECK(strings.size() == 102);
+  CHECK(strings.front() == "a" && strings[2] == "0" && strings.back() == "99");
+  auto copy = strings;
+  auto moved = std::move(strings);
+  CHECK(copy.size() == 102 && moved.size() == 102 && strings.empty() && strings.is_inline());
+  CHECK(std::ranges::equal(copy, moved));
+}
+
+TEST(smallVectorEraseKeepsOrder) {
+  mystl::small_vector<int, 4> numbers{0, 1, 2, 3, 4, 5};
+  numbers.erase(numbers.begin() + 1);
+  numbers.erase(numbers.end() - 1);
+  CHECK(std::ranges::equal(numbers, std::vector{0, 2, 3, 4}));
+  // moving an inline vector moves the elements, not the storage
+  mystl::small_vector<int, 4> small{7, 8};
+  auto moved = std::move(small);
+  CHECK(moved.is_inline() && moved.size() == 2 && moved[1] == 8);
+}
+
+TEST(smallVectorCapacityOverflowThrows) {
+  mystl::small_vector<char, 8> bytes(std::string("chiisai"));
+  CHECK_THROWS(bytes.reserve(size_t{1} << 32), std::length_error);
+  CHECK(bytes.size() == 7 && bytes.capacity() == 8);
+}
+
+namespace {
+// every four consecutive keys share a hash, so they collide and form clusters
+struct ClusteringHash {
+  size_t operator()(int key) const {
+    return static_cast<size_t>(key / 4);
+  }
+};
+}
+
+TEST(flatHashMapInsertAndFind) {
+  mystl::flat_hash_map<int, int> squares{};
+  for (int i = 0; i < 1000; i++)
+    CHECK(squares.try_emplace(i, i * i).second);
+  CHECK(!squares.try_emplace(10, 0).second);
+  CHECK(squares.size() == 1000);
+  for (int i = 0; i < 1000; i++)
+    CHECK(squares.find(i) != squares.end() && squares.find(i)->second == i * i);
+  CHECK(!squares.contains(1000));
+  size_t visited = 0;
+  for (auto &[key, value] : squares)
+    visited += value == key * key;
+  CHECK(visited == 1000);
+}
+
+TEST(flatHashMapBackwardShiftErase) {
+  mystl::flat_hash_map<int, int, ClusteringHash> map{};
+  for (int i = 0; i < 64; i++)
+    map[i] = i;
+  // erasing from the middle of clusters shifts the entries after the hole back, which must keep all of them reachable
+  for (int i = 1; i < 64; i += 3)
+    CHECK(map.erase(i) == 1);
+  CHECK(map.erase(1) == 0);
+  for (int i = 0; i < 64; i++)
+    CHECK(map.contains(i) == (i % 3 != 1));
+  // the holes are filled again, and every key is still found once
+  for (int i = 1; i < 64; i += 3)
+    map[i] = -i;
+  CHECK(map.size() == 64);
+  for (int i = 0; i < 64; i++)
+    CHECK(map.find(i)->second == (i % 3 == 1 ? -i : i));
+  for (int i = 0; i < 64; i++)
+    CHECK(map.erase(i) == 1);
+  CHECK(map.empty() && map.begin() == map.end());
+}
+
+TEST(flatHashMapTransparentLookup) {
+  struct NameHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view name) const {
+      return std::hash<std::string_view>{}(name);
+    }
+  };
+  struct NameEqual {
+    using is_transparent = void;
+    bool operator()(std::string_view lhs, std::string_view rhs) const {
+      return lhs == rhs;
+    }
+  };
+  mystl::flat_hash_map<std::string, int, NameHash, NameEqual> map{};
+  map["entry"] = 1;
+  CHECK(map.contains(std::string_view("entry")));
+  CHECK(map.erase(std::string_view("entry")) == 1 && map.empty());
+}
+
+namespace {
+struct Node : mystl::ilist_node<Node> {
+  explicit Node(int value, int &alive) : value(value), alive(alive) {
+    alive++;
+  }
+  ~Node() {
+    alive--;
+  }
+  int value;
+  int &alive;
+};
+
+std::vector<int> values(const mystl::ilist<Node> &list) {
+  std::vector<int> result{};
+  for (auto node : list)
+    result.push_back(node->value);
+  return result;
+}
+}
+
+TEST(ilistInsertRemoveAndSplice) {
+  mystl::arena arena{};
+  int alive = 0;
+  {
+    mystl::ilist<Node> list{}, other{};
+    for (int i = 0; i < 4; i++)
+      list.push_back(arena.make<Node>(i, alive));
+    list.push_front(arena.make<Node>(-1, alive));
+    list.insert(++list.begin(), arena.make<Node>(10, alive));
+    CHECK((values(list) == std::vector{-1, 10, 0, 1, 2, 3}));
+    // an element moves to another list without being destroyed
+    auto node = list.remove(list.iterator_to(*list.back()));
+    other.push_back(std::move(node));
+    CHECK((values(list) == std::vector{-1, 10, 0, 1, 2}) && (values(other) == std::vector{3}));
+    CHECK(alive == 6);
+    auto next = list.erase(list.iterator_to(*list.front()));
+    CHECK(next == list.begin() && list.front()->value == 10 && alive == 5);
+    CHECK(list.back()->prev()->value == 1 && !list.back()->next());
+    CHECK(list.size() == 4 && other.size() == 1);
+  }
+  CHECK(alive == 0);
+}
+
+TEST(shardedInternerMakesOneObjectPerKey) {
+  mystl::sharded_interner<int, int> interner{};
+  std::atomic<int> made{};
+  std::vector<std::thread> threads{};
+  std::vector<std::vector<const int *>> seen(4);
+  for (size_t t = 0; t < seen.size(); t++)
+    threads.emplace_back([&, t] {
+      for (int key = 0; key < 1000; key++)
+        seen[t].push_back(&interner.intern(key, [&] {
+          made++;
+          return std::make_unique<int>(key);
+        }));
+    });
+  for (auto &thread : threads)
+    thread.join();
+  CHECK(made == 1000 && interner.size() == 1000);
+  for (int key = 0; key < 1000; key++) {
+    CHECK(*seen[0][key] == key);
+    for (auto &objects : seen)
+      CHECK(objects[key] == seen[0][key]);
+    CHECK(interner.find(key) == seen[0][key]);
+  }
+  CHECK(interner.find(1000) == nullptr);
+}
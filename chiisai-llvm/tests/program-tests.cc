@@ -0,0 +1,51 @@
+//
+// Created by creeper on 10/18/26.
+//
+#include <fstream>
+#include <chiisai-llvm/program.h>
+#include <chiisai-llvm/asm-parser.h>
+#include "test.h"
+
+using namespace llvm;
+
+namespace {
+std::unique_ptr<Program> program(const std::filesystem::path &path) {
+  auto ctx = std::make_unique<LLVMContext>();
+  auto module = readAssembly(path, *ctx);
+  return std::make_unique<Program>(std::move(ctx), std::move(module));
+}
+
+int32_t twice(int32_t x) {
+  return 2 * x;
+}
+}
+
+TEST(programInvokesWithTypedArguments) {
+  auto loop = program(test::suitesDir() / "loop.ll");
+  CHECK_THROWS(loop->invoke<int32_t>("sum", 4), std::runtime_error);
+  loop->prepare();
+  CHECK(loop->invoke<int32_t>("sum", 4) == 6);
+  CHECK(loop->invoke<int32_t>("main") == 10);
+  // the signature asked for must be the one the function is defined with
+  CHECK_THROWS(loop->invoke<double>("sum", 4), std::runtime_error);
+  CHECK_THROWS(loop->invoke<int32_t>("sum", 4.0), std::runtime_error);
+  CHECK_THROWS(loop->invoke<int32_t>("sum"), std::runtime_error);
+  CHECK_THROWS(loop->invoke<int32_t>("missing"), std::runtime_error);
+}
+
+TEST(programLinksEveryCallee) {
+  test::ScratchFile source("calls-native.ll");
+  std::ofstream(source.path) << "declare i32 @twice(i32 %x)\n"
+                                "\n"
+                                "define i32 @quad(i32 %x) {\n"
+                                "entry:\n"
+                                "  %y = call i32 @twice(i32 %x)\n"
+                                "  %z = call i32 @twice(i32 %y)\n"
+                                "  ret i32 %z\n"
+                                "}\n";
+  CHECK_THROWS(program(source.path)->prepare(), std::runtime_error);
+  auto bound = program(source.path);
+  bound->bindNative("twice", twice).prepare();
+  CHECK(bound->invoke<int32_t>("quad", 5) == 20 && bound->invoke<int32_t>("twice", 5) == 10);
+  CHECK_THROWS(bound->bindNative("twice", twice), std::runtime_error);
+}
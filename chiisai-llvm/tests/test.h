@@ -0,0 +1,111 @@
+//
+// Created by creeper on 10/18/26.
+//
+
+#ifndef CACTRIE_CHIISAI_LLVM_TESTS_TEST_H
+#define CACTRIE_CHIISAI_LLVM_TESTS_TEST_H
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <unistd.h>
+#include <stdexcept>
+#include <functional>
+#include <filesystem>
+#include <chiisai-llvm/module.h>
+#include <chiisai-llvm/asm-writer.h>
+namespace llvm::test {
+
+// thrown by CHECK, caught by the runner, which reports the test as failed and goes on with the next one
+struct Failure : std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
+struct TestCase {
+  std::string name;
+  std::function<void()> body;
+};
+
+inline std::vector<TestCase> &registry() {
+  static std::vector<TestCase> tests{};
+  return tests;
+}
+
+inline bool registerTest(std::string name, std::function<void()> body) {
+  registry().push_back({std::move(name), std::move(body)});
+  return true;
+}
+
+// the directory of the IR the tests run on
+inline std::filesystem::path suitesDir() {
+  return TEST_SUITES_DIR;
+}
+
+// the text AsmWriter prints for the module, by which the tests compare modules
+inline std::string print(Module &module) {
+  auto file = std::tmpfile();
+  if (!file)
+    throw std::runtime_error("cannot create a temporary file");
+  {
+    AsmWriter writer(fileno(file));
+    writer.print(module);
+    writer.flush();
+  }
+  std::string text(static_cast<size_t>(std::ftell(file)), '\0');
+  std::rewind(file);
+  auto read = std::fread(text.data(), 1, text.size(), file);
+  std::fclose(file);
+  text.resize(read);
+  return text;
+}
+
+// the textual IR of the suites, which the round trips run on
+inline std::vector<std::filesystem::path> suites() {
+  std::vector<std::filesystem::path> paths{};
+  for (const auto &entry : std::filesystem::directory_iterator(suitesDir()))
+    if (entry.path().extension() == ".ll")
+      paths.push_back(entry.path());
+  std::ranges::sort(paths);
+  return paths;
+}
+
+// a file or directory in the temporary directory, removed with the object
+struct ScratchFile {
+  explicit ScratchFile(const std::string &name)
+      : path(std::filesystem::temp_directory_path() / (std::to_string(getpid()) + "-" + name)) {}
+  ScratchFile(const ScratchFile &) = delete;
+  ~ScratchFile() {
+    std::error_code error;
+    std::filesystem::remove_all(path, error);
+  }
+  std::filesystem::path path;
+};
+
+}
+
+// defines a test, which is run by chiisai-llvm-tests, optionally filtered by a substring of its name
+#define TEST(name)                                                                      \
+  static void name();                                                                   \
+  [[maybe_unused]] static const bool name##Registered = llvm::test::registerTest(#name, name); \
+  static void name()
+
+#define CHECK(cond)                                                                     \
+  do {                                                                                  \
+    if (!(cond))                                                                        \
+      throw llvm::test::Failure(std::string(__FILE__) + ":" + std::to_string(__LINE__) + ": " #cond); \
+  } while (false)
+
+// checks that evaluating expr throws an exception of type exception
+#define CHECK_THROWS(expr, exception)                                                   \
+  do {                                                                                  \
+    bool thrown = false;                                                                \
+    try {                                                                               \
+      (void) (expr);                                                                    \
+    } catch (const exception &) {                                                       \
+      thrown = true;                                                                    \
+    }                                                                                   \
+    if (!thrown)                                                                        \
+      throw llvm::test::Failure(std::string(__FILE__) + ":" + std::to_string(__LINE__) + ": " #expr " does not throw"); \
+  } while (false)
+
+#endif //CACTRIE_CHIISAI_LLVM_TESTS_TEST_H